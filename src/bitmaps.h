@@ -0,0 +1,22 @@
+// Generated by tools/build_assets.py from assets/bitmaps, do not edit
+#ifndef BITMAPS_H
+#define BITMAPS_H
+
+#include "packedBitmap.h"
+
+static const uint8_t PROGMEM no_active_device_data[] = {0x04, 0xe0, 0xf0, 0xf8, 0x04, 0x02, 0xce, 0x01, 0x02, 0x02, 0x04, 0xf8, 0x95, 0x20, 0x00, 0xe0, 0x81, 0xff, 0x88, 0x00, 0x00, 0x7f, 0x81, 0x49, 0x02, 0x41, 0x00, 0x26, 0x81, 0x49, 0x02, 0x32, 0x00, 0x7f, 0x81, 0x09, 0x00, 0x06, 0x85, 0x00, 0x00, 0x26, 0x81, 0x49, 0x03, 0x32, 0x00, 0xfc, 0x18, 0x80, 0x24, 0x02, 0x18, 0x00, 0x38, 0x81, 0x44, 0x01, 0x38, 0x00, 0x80, 0x04, 0x02, 0x3f, 0x44, 0x24, 0x80, 0x00, 0x02, 0x44, 0x7d, 0x40, 0x81, 0x00, 0x05, 0x08, 0x7e, 0x09, 0x02, 0x00, 0x4c, 0x81, 0x90, 0x00, 0x7c, 0x87, 0x00, 0x00, 0xff, 0x81, 0x00, 0x84, 0x80, 0x00, 0x9f, 0x81, 0x9d, 0x00, 0x9f, 0x81, 0x80, 0x80, 0x00, 0x82, 0x80, 0x82, 0xff, 0x97, 0x00, 0x00, 0xf8, 0x81, 0x48, 0x00, 0x30, 0x80, 0x00, 0x01, 0x08, 0xf8, 0x82, 0x00, 0x80, 0xa0, 0x00, 0xc0, 0x80, 0x00, 0x00, 0x60, 0x81, 0x80, 0x02, 0xe0, 0x00, 0xc0, 0x81, 0xa0, 0x03, 0xc0, 0x00, 0xe0, 0x40, 0x80, 0x20, 0x00, 0x40, 0x96, 0x00, 0x00, 0xff, 0x81, 0x02, 0x00, 0x03, 0x83, 0x00, 0x00, 0xf8, 0x81, 0xb8, 0x00, 0xf8, 0x80, 0x00, 0x00, 0x03, 0x80, 0x02, 0x00, 0x03, 0x81, 0x00, 0x82, 0xff, 0x01, 0xc0, 0x80, 0x95, 0x00, 0x00, 0x03, 0x84, 0x00, 0x02, 0x02, 0x03, 0x02, 0x80, 0x00, 0x00, 0x01, 0x80, 0x02, 0x03, 0x03, 0x02, 0x00, 0x02, 0x81, 0x04, 0x02, 0x03, 0x00, 0x01, 0x81, 0x02, 0x80, 0x00, 0x00, 0x03, 0x98, 0x00, 0x02, 0x80, 0x40, 0x3f, 0x94, 0x1c, 0x04, 0x0c, 0x07, 0x00, 0x01, 0x03, 0xce, 0x07, 0x01, 0x03, 0x01, 0x9f, 0x00, 0x06, 0xfc, 0x10, 0x20, 0x40, 0xfc, 0x00, 0xe0, 0x81, 0x10, 0x00, 0xe0, 0x85, 0x00, 0x06, 0xf0, 0x48, 0x44, 0x48, 0xf0, 0x00, 0xe0, 0x81, 0x10, 0x01, 0xa0, 0x00, 0x80, 0x10, 0x02, 0xfc, 0x10, 0x90, 0x80, 0x00, 0x01, 0x10, 0xf4, 0x81, 0x00, 0x06, 0x70, 0x80, 0x00, 0x80, 0x70, 0x00, 0xe0, 0x81, 0x50, 0x00, 0x60, 0x85, 0x00, 0x00, 0xfc, 0x81, 0x04, 0x02, 0xf8, 0x00, 0xe0, 0x81, 0x50, 0x06, 0x60, 0x00, 0x70, 0x80, 0x00, 0x80, 0x70, 0x80, 0x00, 0x01, 0x10, 0xf4, 0x81, 0x00, 0x00, 0xe0, 0x81, 0x10, 0x02, 0xa0, 0x00, 0xe0, 0x81, 0x50, 0x00, 0x60, 0x8f, 0x00, 0x00, 0x01, 0x81, 0x00, 0x00, 0x01, 0x80, 0x00, 0x81, 0x01, 0x86, 0x00, 0x00, 0x01, 0x81, 0x00, 0x00, 0x01, 0x80, 0x00, 0x81, 0x01, 0x83, 0x00, 0x00, 0x01, 0x81, 0x00, 0x81, 0x01, 0x82, 0x00, 0x00, 0x01, 0x82, 0x00, 0x81, 0x01, 0x86, 0x00, 0x82, 0x01, 0x81, 0x00, 0x81, 0x01, 0x82, 0x00, 0x00, 0x01, 0x82, 0x00, 0x81, 0x01, 0x81, 0x00, 0x81, 0x01, 0x81, 0x00, 0x81, 0x01, 0x8a, 0x00};
+static const PackedBitmap no_active_device = {112, 49, 389, no_active_device_data, nullptr};
+
+static const uint8_t PROGMEM splash_screen_data[] = {0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xb0, 0x00, 0x06, 0xfc, 0x10, 0x20, 0x40, 0xfc, 0x00, 0xe0, 0x81, 0x10, 0x00, 0xe0, 0x81, 0x00, 0x00, 0xf8, 0x81, 0x48, 0x06, 0x40, 0x48, 0x24, 0xc8, 0x70, 0x80, 0x00, 0x81, 0x10, 0x01, 0xa0, 0x00, 0x80, 0x10, 0x06, 0x04, 0x50, 0x30, 0x10, 0x08, 0x10, 0xf4, 0x80, 0xa0, 0x05, 0xc0, 0x70, 0x80, 0xe0, 0x80, 0x70, 0x80, 0x00, 0x06, 0x50, 0x10, 0xf0, 0xc0, 0xa0, 0x20, 0x00, 0x80, 0x20, 0x06, 0xf8, 0x20, 0xdc, 0x04, 0xe4, 0x04, 0xf8, 0x80, 0x00, 0x0d, 0x50, 0xa8, 0x10, 0x40, 0x20, 0xb0, 0x80, 0xf8, 0xc0, 0x50, 0x20, 0xc0, 0x10, 0xf4, 0x81, 0x00, 0x00, 0xe0, 0x81, 0x10, 0x02, 0xa0, 0x00, 0xe0, 0x81, 0x50, 0x00, 0x60, 0x8f, 0x00, 0x00, 0x01, 0x81, 0x00, 0x00, 0x01, 0x80, 0x00, 0x81, 0x01, 0x82, 0x00, 0x00, 0x03, 0x81, 0x02, 0x80, 0x00, 0x04, 0x02, 0x04, 0x05, 0x04, 0x03, 0x81, 0x01, 0x82, 0x00, 0x0a, 0x03, 0x01, 0x00, 0x01, 0x02, 0x01, 0x00, 0x03, 0x02, 0x03, 0x02, 0x80, 0x00, 0x80, 0x02, 0x02, 0x01, 0x03, 0x01, 0x80, 0x03, 0x80, 0x02, 0x00, 0x01, 0x81, 0x00, 0x0b, 0x01, 0x02, 0x00, 0x01, 0x00, 0x03, 0x02, 0x01, 0x03, 0x01, 0x02, 0x00, 0x80, 0x02, 0x02, 0x01, 0x00, 0x02, 0x81, 0x00, 0x00, 0x03, 0x81, 0x01, 0x81, 0x00, 0x81, 0x01, 0x81, 0x00, 0x81, 0x01, 0x8a, 0x00};
+static const PackedBitmap splash_screen = {112, 51, 204, splash_screen_data, &no_active_device};
+
+static const uint8_t PROGMEM configuring_data[] = {0x0d, 0x03, 0x06, 0x08, 0x10, 0x20, 0xc0, 0x7c, 0x92, 0xad, 0xc3, 0xa3, 0xa0, 0x58, 0x38, 0x84, 0x00, 0x00, 0xe0, 0x81, 0x10, 0x02, 0x20, 0x00, 0x80, 0x81, 0x40, 0x03, 0x80, 0x00, 0xc0, 0x80, 0x80, 0x40, 0x00, 0x80, 0x80, 0x00, 0x03, 0x80, 0xe0, 0x90, 0x20, 0x80, 0x00, 0x01, 0x40, 0xd0, 0x81, 0x00, 0x00, 0x80, 0x80, 0x40, 0x03, 0xc0, 0x80, 0x00, 0xc0, 0x81, 0x00, 0x03, 0xc0, 0x00, 0xc0, 0x80, 0x80, 0x40, 0x00, 0x80, 0x80, 0x00, 0x01, 0x40, 0xd0, 0x81, 0x00, 0x01, 0xc0, 0x80, 0x80, 0x40, 0x02, 0x80, 0x00, 0x80, 0x80, 0x40, 0x01, 0xc0, 0x80, 0x8f, 0x00, 0x0d, 0x30, 0x28, 0x14, 0x0a, 0x05, 0x02, 0x01, 0x05, 0x0e, 0x1a, 0x36, 0x6c, 0x58, 0x70, 0x84, 0x00, 0x00, 0x03, 0x81, 0x04, 0x02, 0x02, 0x00, 0x03, 0x81, 0x04, 0x02, 0x03, 0x00, 0x07, 0x81, 0x00, 0x00, 0x07, 0x81, 0x00, 0x00, 0x07, 0x82, 0x00, 0x02, 0x04, 0x07, 0x04, 0x80, 0x00, 0x00, 0x01, 0x80, 0x0a, 0x03, 0x09, 0x07, 0x00, 0x03, 0x80, 0x04, 0x03, 0x02, 0x07, 0x00, 0x07, 0x84, 0x00, 0x02, 0x04, 0x07, 0x04, 0x80, 0x00, 0x00, 0x07, 0x81, 0x00, 0x02, 0x07, 0x00, 0x01, 0x80, 0x0a, 0x01, 0x09, 0x07, 0x81, 0x00, 0x80, 0x06, 0x82, 0x00, 0x80, 0x06, 0x82, 0x00, 0x80, 0x06};
+static const PackedBitmap configuring = {102, 15, 189, configuring_data, nullptr};
+
+static const uint8_t PROGMEM heart_filled_data[] = {0x06, 0x06, 0x0f, 0x1f, 0x3e, 0x1f, 0x0f, 0x06};
+static const PackedBitmap heart_filled = {7, 6, 8, heart_filled_data, nullptr};
+
+static const uint8_t PROGMEM heart_outline_data[] = {0x06, 0x06, 0x09, 0x11, 0x22, 0x11, 0x09, 0x06};
+static const PackedBitmap heart_outline = {7, 6, 8, heart_outline_data, nullptr};
+
+#endif
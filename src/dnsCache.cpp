@@ -0,0 +1,284 @@
+#include "dnsCache.h"
+#include <WiFi.h>
+#include <lwip/tcpip.h>
+
+DnsCache dnsCache;
+
+DnsCache::DnsCache() : refreshStart(0),
+                       refreshing(false),
+                       refreshFinished(false),
+                       refreshOk(false),
+                       refreshAddress(0),
+                       refreshEnd(0),
+                       resolveMs(0),
+                       hits(0),
+                       misses(0),
+                       staleServed(0),
+                       failures(0),
+                       refreshes(0),
+                       lookupMsTotal(0),
+                       lookups(0),
+                       lastReport(0)
+{
+    for (int i = 0; i < MAX_ENTRIES; i++)
+    {
+        entries[i].valid = false;
+        entries[i].resolvedAt = 0;
+        entries[i].lastFailure = 0;
+        entries[i].used = false;
+    }
+    portMUX_INITIALIZE(&refreshLock);
+}
+
+DnsCache::Entry *DnsCache::find(const char *host)
+{
+    for (int i = 0; i < MAX_ENTRIES; i++)
+    {
+        if (entries[i].host == host)
+        {
+            return &entries[i];
+        }
+    }
+    return nullptr;
+}
+
+// Existing entry for host, else a free slot, else the oldest one
+DnsCache::Entry *DnsCache::slotFor(const char *host)
+{
+    Entry *entry = find(host);
+    if (entry != nullptr)
+    {
+        return entry;
+    }
+
+    Entry *oldest = &entries[0];
+    for (int i = 0; i < MAX_ENTRIES; i++)
+    {
+        if (entries[i].host.length() == 0)
+        {
+            oldest = &entries[i];
+            break;
+        }
+        if ((long)(entries[i].resolvedAt - oldest->resolvedAt) < 0)
+        {
+            oldest = &entries[i];
+        }
+    }
+
+    oldest->host = host;
+    oldest->valid = false;
+    oldest->lastFailure = 0;
+    oldest->used = false;
+    return oldest;
+}
+
+bool DnsCache::lookup(Entry &entry)
+{
+    unsigned long start = millis();
+    IPAddress ip;
+    bool ok = WiFi.hostByName(entry.host.c_str(), ip) == 1 && ip != IPAddress(0, 0, 0, 0);
+    lookupDone(entry, ok, (uint32_t)ip, millis() - start);
+    return ok;
+}
+
+// A failure keeps the old address, it stays usable as a stale fallback
+void DnsCache::lookupDone(Entry &entry, bool ok, uint32_t address, unsigned long elapsed)
+{
+    lookups++;
+    lookupMsTotal += elapsed;
+
+    if (!ok)
+    {
+        failures++;
+        entry.lastFailure = max(millis(), 1UL);
+        Serial.printf("DNS lookup for %s failed after %lu ms\n", entry.host.c_str(), elapsed);
+        return;
+    }
+
+    entry.ip = IPAddress(address);
+    entry.resolvedAt = millis();
+    entry.lastFailure = 0;
+    entry.valid = true;
+}
+
+bool DnsCache::resolve(const char *host, IPAddress &ip)
+{
+    unsigned long now = millis();
+    resolveMs = 0;
+
+    Entry *entry = find(host);
+    if (entry != nullptr && entry->valid && now - entry->resolvedAt < TTL)
+    {
+        hits++;
+        entry->used = true;
+        ip = entry->ip;
+        return true;
+    }
+
+    misses++;
+    entry = slotFor(host);
+    entry->used = true;
+    unsigned long start = millis();
+    bool ok = lookup(*entry);
+    resolveMs = millis() - start;
+
+    if (ok)
+    {
+        ip = entry->ip;
+        return true;
+    }
+
+    // Stale on error: an old address beats no connection at all
+    if (entry->valid && now - entry->resolvedAt < MAX_STALE)
+    {
+        staleServed++;
+        Serial.printf("DNS: using stale address for %s\n", host);
+        ip = entry->ip;
+        return true;
+    }
+    return false;
+}
+
+void DnsCache::invalidate(const char *host)
+{
+    Entry *entry = find(host);
+    if (entry != nullptr && entry->valid)
+    {
+        // Still usable as a stale fallback, but the next resolve looks it up
+        entry->resolvedAt = millis() - TTL;
+    }
+}
+
+// Entries nobody resolved since their last lookup are left to expire,
+// the next resolve() looks them up again
+bool DnsCache::refreshDue()
+{
+    if (refreshing)
+    {
+        return refreshFinished;
+    }
+
+    unsigned long now = millis();
+    for (int i = 0; i < MAX_ENTRIES; i++)
+    {
+        const Entry &entry = entries[i];
+        if (!entry.valid || !entry.used || (entry.lastFailure != 0 && now - entry.lastFailure < RETRY_INTERVAL))
+            continue;
+        if (now - entry.resolvedAt >= TTL - REFRESH_MARGIN && now - entry.resolvedAt < MAX_STALE)
+            return true;
+    }
+    return false;
+}
+
+void DnsCache::refresh()
+{
+    if (refreshing)
+    {
+        if (refreshFinished)
+        {
+            finishRefresh();
+        }
+        return;
+    }
+
+    unsigned long now = millis();
+    Entry *oldest = nullptr;
+    for (int i = 0; i < MAX_ENTRIES; i++)
+    {
+        Entry &entry = entries[i];
+        if (!entry.valid || !entry.used || (entry.lastFailure != 0 && now - entry.lastFailure < RETRY_INTERVAL))
+            continue;
+        if (oldest == nullptr || (long)(entry.resolvedAt - oldest->resolvedAt) < 0)
+        {
+            oldest = &entry;
+        }
+    }
+
+    if (oldest == nullptr || now - oldest->resolvedAt < TTL - REFRESH_MARGIN || now - oldest->resolvedAt >= MAX_STALE)
+    {
+        return;
+    }
+
+    startRefresh(*oldest);
+}
+
+void DnsCache::startRefresh(Entry &entry)
+{
+    refreshes++;
+    entry.used = false;
+    refreshStart = millis();
+
+    refreshHost = entry.host;
+    refreshFinished = false;
+    refreshing = true;
+
+    ip_addr_t addr;
+#if LWIP_TCPIP_CORE_LOCKING
+    LOCK_TCPIP_CORE();
+#endif
+    err_t err = dns_gethostbyname_addrtype(entry.host.c_str(), &addr, dnsFound, this, LWIP_DNS_ADDRTYPE_IPV4);
+#if LWIP_TCPIP_CORE_LOCKING
+    UNLOCK_TCPIP_CORE();
+#endif
+
+    if (err == ERR_INPROGRESS)
+    {
+        return; // dnsFound() reports back
+    }
+
+    // Answered from the lwIP cache, or the query could not be sent
+    refreshing = false;
+    bool ok = err == ERR_OK && !ip_addr_isany(&addr);
+    lookupDone(entry, ok, ok ? ip4_addr_get_u32(ip_2_ip4(&addr)) : 0, millis() - refreshStart);
+}
+
+void DnsCache::dnsFound(const char *name, const ip_addr_t *addr, void *arg)
+{
+    DnsCache *cache = static_cast<DnsCache *>(arg);
+    unsigned long now = millis();
+
+    portENTER_CRITICAL(&cache->refreshLock);
+    cache->refreshOk = addr != nullptr && !ip_addr_isany(addr);
+    cache->refreshAddress = cache->refreshOk ? ip4_addr_get_u32(ip_2_ip4(addr)) : 0;
+    cache->refreshEnd = now;
+    cache->refreshFinished = true;
+    portEXIT_CRITICAL(&cache->refreshLock);
+}
+
+void DnsCache::finishRefresh()
+{
+    portENTER_CRITICAL(&refreshLock);
+    bool ok = refreshOk;
+    uint32_t address = refreshAddress;
+    unsigned long end = refreshEnd;
+    refreshFinished = false;
+    portEXIT_CRITICAL(&refreshLock);
+    refreshing = false;
+
+    // The slot may have gone to another host while the query ran
+    Entry *entry = find(refreshHost.c_str());
+    if (entry != nullptr)
+    {
+        lookupDone(*entry, ok, address, end - refreshStart);
+    }
+}
+
+void DnsCache::report()
+{
+    unsigned long now = millis();
+    if (lookups == 0 || now - lastReport < REPORT_INTERVAL)
+    {
+        return;
+    }
+
+    Serial.printf("DNS: %lu hits, %lu misses, %lu background refreshes, %lu failed, %lu stale served, lookup avg %lu ms\n",
+                  hits, misses, refreshes, failures, staleServed, lookupMsTotal / lookups);
+    hits = 0;
+    misses = 0;
+    refreshes = 0;
+    failures = 0;
+    staleServed = 0;
+    lookups = 0;
+    lookupMsTotal = 0;
+    lastReport = now;
+}
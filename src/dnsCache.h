@@ -0,0 +1,91 @@
+#ifndef DNSCACHE_H
+#define DNSCACHE_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <lwip/dns.h>
+#include "fixedString.h"
+
+// Caches the addresses of the Spotify hosts so reconnects skip the lookup.
+// The Arduino resolver does not expose record TTLs, so entries live for a
+// fixed TTL. Entries of hosts used since their last refresh are refreshed
+// close to expiry by an asynchronous lwIP query, so the loop never waits
+// on it. When a lookup fails the last known address is served for up to
+// MAX_STALE.
+class DnsCache
+{
+public:
+    static const int MAX_ENTRIES = 4;
+    static const unsigned long TTL = 300000;           // 5 minutes
+    static const unsigned long REFRESH_MARGIN = 30000; // Background refresh this long before expiry
+    static const unsigned long MAX_STALE = 3600000;    // Serve an expired address this long if lookups fail
+    static const unsigned long RETRY_INTERVAL = 10000; // Before a failed host is refreshed again
+    static const unsigned long REPORT_INTERVAL = 60000;
+
+    DnsCache();
+
+    // Address for host, from the cache or a lookup; false if neither works
+    bool resolve(const char *host, IPAddress &ip);
+
+    // Drop a cached address that did not accept a connection
+    void invalidate(const char *host);
+
+    // A used entry is close to expiry, or a background lookup has finished
+    bool refreshDue();
+
+    // Collect a finished background lookup, else start one for the used
+    // entry closest to expiry. Never blocks.
+    void refresh();
+
+    // Time the last resolve() spent on the lookup, 0 for a cache hit
+    unsigned long lastResolveMs() const { return resolveMs; }
+
+    void report();
+
+private:
+    struct Entry
+    {
+        FixedString<32> host;
+        IPAddress ip;
+        unsigned long resolvedAt;
+        unsigned long lastFailure;
+        bool valid;
+        bool used; // resolve() handed it out since the last background refresh
+    };
+
+    Entry *find(const char *host);
+    Entry *slotFor(const char *host);
+    bool lookup(Entry &entry);
+    void lookupDone(Entry &entry, bool ok, uint32_t address, unsigned long elapsed);
+    void startRefresh(Entry &entry);
+    void finishRefresh();
+
+    // Runs in the lwIP thread
+    static void dnsFound(const char *name, const ip_addr_t *addr, void *arg);
+
+    Entry entries[MAX_ENTRIES];
+
+    // Background lookup in flight, the result is written by dnsFound()
+    FixedString<32> refreshHost;
+    unsigned long refreshStart;
+    bool refreshing;
+    volatile bool refreshFinished;
+    bool refreshOk;
+    uint32_t refreshAddress;
+    unsigned long refreshEnd;
+    portMUX_TYPE refreshLock;
+
+    unsigned long resolveMs;
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long staleServed;
+    unsigned long failures;
+    unsigned long refreshes;
+    unsigned long lookupMsTotal;
+    unsigned long lookups;
+    unsigned long lastReport;
+};
+
+extern DnsCache dnsCache;
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef FIXEDSTRING_H
+#define FIXEDSTRING_H
+
+#include <Arduino.h>
+
+// Inline, heap-free string of at most N-1 bytes. Text that does not fit is
+// truncated at a UTF-8 codepoint boundary, never in the middle of a character.
+template <size_t N>
+class FixedString
+{
+public:
+    FixedString() : len(0) { data[0] = '\0'; }
+    FixedString(const char *value) { assign(value); }
+
+    void assign(const char *value)
+    {
+        assign(value, value ? strlen(value) : 0);
+    }
+
+    void assign(const char *value, size_t length)
+    {
+        if (value == nullptr)
+            length = 0;
+
+        if (length > N - 1)
+        {
+            length = N - 1;
+            // Back up over continuation bytes (10xxxxxx) to a character start
+            while (length > 0 && (value[length] & 0xC0) == 0x80)
+                length--;
+        }
+
+        if (length > 0)
+            memcpy(data, value, length);
+        data[length] = '\0';
+        len = length;
+    }
+
+    FixedString &operator=(const char *value)
+    {
+        assign(value);
+        return *this;
+    }
+
+    const char *c_str() const { return data; }
+    size_t length() const { return len; }
+    bool isEmpty() const { return len == 0; }
+    static constexpr size_t capacity() { return N - 1; }
+
+    bool operator==(const char *other) const { return other != nullptr && strcmp(data, other) == 0; }
+    bool operator!=(const char *other) const { return !(*this == other); }
+    template <size_t M>
+    bool operator==(const FixedString<M> &other) const { return len == other.length() && strcmp(data, other.c_str()) == 0; }
+    template <size_t M>
+    bool operator!=(const FixedString<M> &other) const { return !(*this == other); }
+
+private:
+    char data[N];
+    size_t len;
+};
+
+#endif
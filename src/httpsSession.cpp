@@ -0,0 +1,634 @@
+#include "httpsSession.h"
+#include "latencyTrace.h"
+#include "requestScheduler.h"
+#include "soakTest.h"
+
+HttpsSession::HttpsSession(Client &client, bool (*connect)(const char *host)) : authRejected(false),
+                                                                               backoffUntil(0),
+                                                                               client(client),
+                                                                               connect(connect),
+                                                                               lastConnectionTime(0),
+                                                                               requestCount(0),
+                                                                               sentMs(0),
+                                                                               firstByteMs(0),
+                                                                               lastWritten(false),
+                                                                               lastStatus(0)
+{
+}
+
+bool HttpsSession::ensureConnection(const char *host)
+{
+    unsigned long currentTime = millis();
+
+    // Check if connection is stale or needs refresh
+    bool needsReconnect = false;
+
+    if (!client.connected())
+    {
+        Serial.println("Connection lost, reconnecting...");
+        needsReconnect = true;
+    }
+    else if (connectedHost != host)
+    {
+        // The token endpoint lives on another host than the API
+        Serial.println("Switching host to " + String(host));
+        needsReconnect = true;
+    }
+    else if (currentTime - lastConnectionTime > CONNECTION_TIMEOUT)
+    {
+        Serial.println("Connection idle too long, reconnecting...");
+        needsReconnect = true;
+    }
+    else if (requestCount >= MAX_REQUESTS_PER_CONNECTION)
+    {
+        Serial.println("Max requests reached, reconnecting...");
+        needsReconnect = true;
+    }
+
+    if (needsReconnect)
+    {
+        client.stop();
+        connectedHost = "";
+        delay(100);
+        soakMonitor.recordReconnect();
+
+        if (!connect(host))
+        {
+            return false;
+        }
+        connectedHost = host;
+        requestCount = 0;
+    }
+
+    lastConnectionTime = currentTime;
+    requestCount++;
+    return true;
+}
+
+void HttpsSession::closeConnection()
+{
+    if (client.connected())
+    {
+        client.stop();
+        Serial.println("Connection closed");
+    }
+    requestCount = 0;
+}
+
+// Write one request on the connection
+bool HttpsSession::writeRequest(
+    const char *host,
+    const char *path,
+    const String &method,
+    const String &headers,
+    const String &body)
+{
+    sentMs = millis();
+
+    // ---- Request line ----
+    client.print(method + " " + path + " HTTP/1.1\r\n");
+    client.print("Host: " + String(host) + "\r\n");
+    client.print("User-Agent: ESP32\r\n");
+    client.print("Connection: keep-alive\r\n"); // Changed from "close"
+
+    // ---- Custom headers ----
+    client.print(headers);
+
+    // ---- Content-Length if body exists ----
+    if (body.length() > 0)
+    {
+        client.print("Content-Length: ");
+        client.print(body.length());
+        client.print("\r\n");
+    }
+
+    client.print("\r\n");
+
+    // ---- Body ----
+    if (body.length() > 0)
+    {
+        client.print(body);
+    }
+    latencyTracer.mark(TRACE_SENT);
+
+    return client.connected();
+}
+
+// Read the status line and headers of a response
+bool HttpsSession::readResponseHead(int &statusCode, int &contentLength, bool &chunked)
+{
+    // ---- Read status line ----
+    unsigned long timeout = millis();
+    while (client.available() == 0)
+    {
+        if (millis() - timeout > RESPONSE_TIMEOUT || !client.connected())
+        {
+            Serial.println("Request timeout");
+            closeConnection(); // Force reconnect on timeout
+            return false;
+        }
+        // A button press does not wait behind a slow poll; the late
+        // response would desync the connection, so it goes too
+        if (requestScheduler.shouldAbort(true))
+        {
+            closeConnection();
+            return false;
+        }
+        delay(10);
+    }
+    firstByteMs = millis();
+    latencyTracer.mark(TRACE_FIRST_BYTE);
+
+    // Read and parse status line
+    String statusLine = client.readStringUntil('\n');
+    statusCode = statusLine.substring(9, 12).toInt();
+
+    // ---- Read headers ----
+    contentLength = -1;
+    chunked = false;
+    int retryAfter = 1;
+    bool headersEnded = false;
+
+    while (client.connected() || client.available())
+    {
+        String line = client.readStringUntil('\n');
+        if (line == "\r")
+        {
+            headersEnded = true;
+            break;
+        }
+        // Every header line ends in CR, nothing at all is a read timeout
+        if (line.length() == 0)
+            break;
+
+        // Parse Content-Length
+        if (line.startsWith("Content-Length:"))
+        {
+            contentLength = line.substring(15).toInt();
+        }
+        // Check for chunked encoding
+        if (line.indexOf("Transfer-Encoding: chunked") >= 0)
+        {
+            chunked = true;
+        }
+        if (line.startsWith("Retry-After:"))
+        {
+            retryAfter = max((int)line.substring(12).toInt(), 1);
+        }
+    }
+
+    if (!headersEnded)
+    {
+        Serial.println("Connection dropped in the headers");
+        closeConnection();
+        statusCode = 0; // No answer as far as retries go
+        return false;
+    }
+
+    if (statusCode >= 400)
+    {
+        Serial.println("HTTP status " + String(statusCode));
+        soakMonitor.recordStatus(statusCode);
+    }
+    if (statusCode == 401)
+    {
+        authRejected = true;
+    }
+    if (statusCode == 429)
+    {
+        backoffUntil = millis() + retryAfter * 1000UL;
+    }
+
+    // These never carry a body, whatever the headers say
+    if (statusCode == 204 || statusCode == 304)
+    {
+        contentLength = 0;
+        chunked = false;
+    }
+
+    return true;
+}
+
+// Read one complete response, leaving the connection at the start of the next.
+// False means the connection is unusable; an error status still returns true.
+bool HttpsSession::readResponse(String &responseBody, int &statusCode)
+{
+    responseBody = "";
+
+    int contentLength;
+    bool chunked;
+    if (!readResponseHead(statusCode, contentLength, chunked))
+    {
+        return false;
+    }
+
+    // ---- Read body ----
+    if (contentLength == 0)
+    {
+        // No body (e.g., 204 response)
+        return true;
+    }
+    else if (contentLength > 0)
+    {
+        // Read exact content length
+        responseBody.reserve(contentLength);
+        int totalRead = 0;
+        unsigned long lastData = millis();
+        while (totalRead < contentLength && client.connected())
+        {
+            if (client.available())
+            {
+                char c = client.read();
+                responseBody += c;
+                totalRead++;
+                lastData = millis();
+            }
+            else if (requestScheduler.shouldAbort(true) || millis() - lastData > RESPONSE_TIMEOUT)
+            {
+                break;
+            }
+            else
+            {
+                delay(1);
+            }
+        }
+
+        // A short body leaves the connection out of step, start over
+        if (totalRead < contentLength)
+        {
+            Serial.println("Connection dropped mid-body");
+            closeConnection();
+            return false;
+        }
+    }
+    else if (chunked)
+    {
+        // Handle chunked encoding
+        char buffer[256];
+        while (true)
+        {
+            String chunkSizeLine = client.readStringUntil('\n');
+            if (chunkSizeLine.length() == 0)
+            {
+                // The last chunk never came
+                Serial.println("Truncated chunk");
+                closeConnection();
+                return false;
+            }
+            int chunkSize = strtol(chunkSizeLine.c_str(), NULL, 16);
+
+            if (chunkSize == 0)
+            {
+                client.readStringUntil('\n'); // Final CRLF, the next response follows
+                break;
+            }
+
+            while (chunkSize > 0)
+            {
+                if (client.available() == 0 && requestScheduler.shouldAbort(true))
+                {
+                    closeConnection();
+                    return false;
+                }
+                size_t got = client.readBytes(buffer, min(chunkSize, (int)sizeof(buffer)));
+                if (got == 0)
+                {
+                    Serial.println("Truncated chunk");
+                    closeConnection();
+                    return false;
+                }
+                responseBody.concat(buffer, got);
+                chunkSize -= got;
+            }
+            client.readStringUntil('\n');
+        }
+    }
+    else
+    {
+        // No Content-Length header, read until connection closes or timeout
+        unsigned long timeout = millis();
+        while (client.connected() || client.available())
+        {
+            if (client.available())
+            {
+                responseBody += client.readString();
+                timeout = millis();
+            }
+            else if (requestScheduler.shouldAbort(true))
+            {
+                closeConnection();
+                return false;
+            }
+            else
+            {
+                delay(1);
+            }
+            if (millis() - timeout > UNTIL_CLOSE_TIMEOUT)
+                break;
+        }
+    }
+
+    return true;
+}
+
+// Response body as a Stream, undoing chunked transfer encoding on the fly
+class HttpBodyStream : public Stream
+{
+public:
+    HttpBodyStream(Client &client, int contentLength, bool chunked) : client(client),
+                                                                      remaining(chunked ? 0 : contentLength),
+                                                                      chunked(chunked),
+                                                                      started(false),
+                                                                      finished(!chunked && contentLength == 0),
+                                                                      cancelled(false),
+                                                                      cut(false)
+    {
+        setTimeout(0); // read() already waits on the socket
+    }
+
+    int available() override { return finished ? 0 : client.available(); }
+    int peek() override { return fill() ? client.peek() : -1; }
+    size_t write(uint8_t) override { return 0; }
+
+    int read() override
+    {
+        if (!fill())
+        {
+            return -1;
+        }
+
+        // Gives way to a button press like readResponse() does
+        if (client.available() == 0 && requestScheduler.shouldAbort(true))
+        {
+            finished = true;
+            cancelled = true;
+            return -1;
+        }
+
+        uint8_t c;
+        if (client.readBytes(&c, 1) != 1)
+        {
+            finished = true;
+            cut = remaining != -1; // Only a body without length may end on a close
+            return -1;
+        }
+        if (remaining > 0)
+            remaining--;
+        return c;
+    }
+
+    // The read stopped for user input, the rest of the body is still in flight
+    bool wasCancelled() const { return cancelled; }
+
+    // The body stopped short of its length or last chunk
+    bool wasCut() const { return cut; }
+
+    // Skip whatever the parser left unread so the next response starts clean
+    void drain()
+    {
+        while (read() >= 0)
+        {
+        }
+    }
+
+private:
+    // Make sure the current chunk has bytes left; -1 remaining reads until close
+    bool fill()
+    {
+        if (finished)
+            return false;
+        if (remaining != 0)
+            return true;
+        if (!chunked)
+        {
+            finished = true;
+            return false;
+        }
+
+        if (started)
+            client.readStringUntil('\n'); // CRLF after the previous chunk
+        started = true;
+
+        String sizeLine = client.readStringUntil('\n');
+        remaining = strtol(sizeLine.c_str(), NULL, 16);
+        if (remaining <= 0)
+        {
+            cut = sizeLine.length() == 0;
+            if (!cut)
+                client.readStringUntil('\n'); // Final CRLF
+            finished = true;
+            return false;
+        }
+        return true;
+    }
+
+    Client &client;
+    int remaining;
+    bool chunked;
+    bool started;
+    bool finished;
+    bool cancelled;
+    bool cut;
+};
+
+// Inside a 429 Retry-After window requests fail without touching the network
+bool HttpsSession::rateLimited()
+{
+    if ((long)(backoffUntil - millis()) <= 0)
+    {
+        return false;
+    }
+    soakMonitor.recordRequest(false);
+    return true;
+}
+
+// Only the filtered fields are ever held in memory
+bool HttpsSession::requestJson(
+    const char *host,
+    const char *path,
+    const String &headers,
+    JsonDocument &doc,
+    const JsonDocument &filter)
+{
+    if (rateLimited())
+    {
+        return false;
+    }
+
+    // A button press does not wait behind a poll. Nothing is written yet,
+    // so the connection stays usable for the command.
+    if (requestScheduler.shouldAbort(false))
+    {
+        return false;
+    }
+
+    if (!ensureConnection(host))
+    {
+        Serial.println("Failed to ensure connection");
+        soakMonitor.recordRequest(false);
+        return false;
+    }
+
+    if (!writeRequest(host, path, "GET", headers, ""))
+    {
+        Serial.println("Connection dropped while sending");
+        closeConnection();
+        soakMonitor.recordRequest(false);
+        return false;
+    }
+
+    int statusCode;
+    int contentLength;
+    bool chunked;
+    if (!readResponseHead(statusCode, contentLength, chunked))
+    {
+        soakMonitor.recordRequest(false);
+        return false;
+    }
+
+    HttpBodyStream body(client, contentLength, chunked);
+    DeserializationError error = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    body.drain();
+
+    // The body ran until the server closed the connection, or the rest of it
+    // would arrive as the start of the next response
+    if ((contentLength < 0 && !chunked) || body.wasCancelled() || body.wasCut())
+    {
+        closeConnection();
+    }
+    if (body.wasCancelled() || body.wasCut())
+    {
+        if (body.wasCut())
+            Serial.println("Connection dropped mid-body");
+        soakMonitor.recordRequest(false);
+        return false;
+    }
+
+    if (statusCode >= 400)
+    {
+        Serial.println("HTTP " + String(statusCode) + " for " + String(path));
+        soakMonitor.recordRequest(false);
+        return false;
+    }
+    if (error)
+    {
+        Serial.print("JSON parsing failed: ");
+        Serial.println(error.c_str());
+        soakMonitor.recordRequest(false);
+        return false;
+    }
+    soakMonitor.recordRequest(true);
+    return true;
+}
+
+bool HttpsSession::request(
+    const char *host,
+    const char *path,
+    const String &method,
+    const String &headers,
+    const String &body,
+    String &responseBody)
+{
+    lastWritten = false;
+    lastStatus = 0;
+
+    if (rateLimited())
+    {
+        return false;
+    }
+
+    // A button press does not wait behind a poll. Nothing is written yet,
+    // so the connection stays usable for the command.
+    if (requestScheduler.shouldAbort(false))
+    {
+        return false;
+    }
+
+    if (!ensureConnection(host))
+    {
+        Serial.println("Failed to ensure connection");
+        soakMonitor.recordRequest(false);
+        return false;
+    }
+
+    if (!writeRequest(host, path, method, headers, body))
+    {
+        Serial.println("Connection dropped while sending");
+        closeConnection();
+        soakMonitor.recordRequest(false);
+        return false;
+    }
+
+    lastWritten = true;
+
+    int statusCode = 0;
+    bool ok = readResponse(responseBody, statusCode) && statusCode < 400;
+    lastStatus = statusCode;
+    soakMonitor.recordRequest(ok);
+    return ok;
+}
+
+// Bodyless requests, one round trip for the whole batch
+bool HttpsSession::pipeline(
+    const char *host,
+    PipelineRequest *requests,
+    int count)
+{
+    if (count == 0)
+    {
+        return true;
+    }
+
+    bool connected = !rateLimited() && ensureConnection(host);
+    if (connected)
+    {
+        requestCount += count - 1;
+
+        // ---- Write everything first ----
+        for (int i = 0; i < count; i++)
+        {
+            if (!writeRequest(host, requests[i].path.c_str(), requests[i].method, requests[i].headers, ""))
+                break;
+            requests[i].written = true;
+        }
+
+        // ---- Responses arrive in request order ----
+        for (int i = 0; i < count && requests[i].written; i++)
+        {
+            if (!readResponse(requests[i].response, requests[i].statusCode))
+                break;
+            requests[i].completed = requests[i].statusCode < 400;
+            soakMonitor.recordRequest(requests[i].completed);
+        }
+    }
+
+    // ---- Recover from a dropped pipeline ----
+    bool allCompleted = true;
+    for (int i = 0; i < count; i++)
+    {
+        if (requests[i].completed)
+            continue;
+
+        // Answered with an error, repeating it will not help
+        if (requests[i].statusCode != 0)
+        {
+            allCompleted = false;
+            continue;
+        }
+
+        // A written POST may already have been applied, repeating it could skip twice
+        if (requests[i].written && !requests[i].idempotent)
+        {
+            Serial.println("Pipeline dropped, not retrying " + requests[i].method + " " + requests[i].path);
+            allCompleted = false;
+            continue;
+        }
+
+        requests[i].completed = request(host, requests[i].path.c_str(), requests[i].method, requests[i].headers, "", requests[i].response);
+        requests[i].written |= lastWritten;
+        requests[i].statusCode = lastStatus;
+        allCompleted &= requests[i].completed;
+    }
+
+    return allCompleted;
+}
@@ -0,0 +1,93 @@
+#ifndef HTTPSSESSION_H
+#define HTTPSSESSION_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <ArduinoJson.h>
+
+// One request of a pipelined batch
+struct PipelineRequest
+{
+    String method;
+    String path;
+    String headers;
+    bool idempotent = false;
+    bool written = false;
+    bool completed = false;
+    int statusCode = 0; // 0 until a response arrived
+    String response;
+};
+
+// HTTP/1.1 keep-alive requests on one client connection. Reconnects when
+// the connection drops, idles too long, has served MAX_REQUESTS_PER_CONNECTION
+// or is needed for another host. Honours 429 Retry-After, flags 401s and
+// gives way to user input through the request scheduler. The transport is
+// any Client, so the host tests run it against a mock endpoint.
+class HttpsSession
+{
+public:
+    static const unsigned long CONNECTION_TIMEOUT = 60000;      // 60 seconds idle timeout
+    static const unsigned int MAX_REQUESTS_PER_CONNECTION = 50; // Reconnect after N requests
+    static const unsigned long RESPONSE_TIMEOUT = 10000;        // Without a byte of the response
+    static const unsigned long UNTIL_CLOSE_TIMEOUT = 2000;      // Bodies without length end after this
+
+    // connect opens the client to host (port 443); false if it could not
+    HttpsSession(Client &client, bool (*connect)(const char *host));
+
+    bool ensureConnection(const char *host);
+    void closeConnection();
+
+    bool request(
+        const char *host,
+        const char *path,
+        const String &method,
+        const String &headers,
+        const String &body,
+        String &responseBody);
+
+    // GET a JSON resource and parse it straight off the socket through a filter
+    bool requestJson(
+        const char *host,
+        const char *path,
+        const String &headers,
+        JsonDocument &doc,
+        const JsonDocument &filter);
+
+    // Write all requests before reading any response; unanswered requests are
+    // retried one by one if they were never sent or are idempotent
+    bool pipeline(
+        const char *host,
+        PipelineRequest *requests,
+        int count);
+
+    // Send and first-byte times of the latest request, for the playback clock
+    unsigned long requestSentMs() const { return sentMs; }
+    unsigned long responseStartMs() const { return firstByteMs; }
+
+    // Outcome of the latest request(), decides whether a failed command is journaled
+    bool lastRequestWritten() const { return lastWritten; }
+    int lastStatusCode() const { return lastStatus; }
+
+    bool authRejected;          // A request got 401, refresh before the token expires
+    unsigned long backoffUntil; // Set by 429 Retry-After, requests fail fast until then
+
+private:
+    bool rateLimited();
+    bool writeRequest(const char *host, const char *path, const String &method, const String &headers, const String &body);
+    bool readResponseHead(int &statusCode, int &contentLength, bool &chunked);
+    bool readResponse(String &responseBody, int &statusCode);
+
+    Client &client;
+    bool (*connect)(const char *host);
+    String connectedHost;
+    unsigned long lastConnectionTime;
+    unsigned int requestCount;
+    unsigned long sentMs;
+    unsigned long firstByteMs;
+    bool lastWritten;
+    int lastStatus;
+};
+
+extern HttpsSession httpsSession;
+
+#endif
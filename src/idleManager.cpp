@@ -0,0 +1,179 @@
+#include "idleManager.h"
+#include "inputEvents.h"
+#include <esp_sleep.h>
+#include <esp_wifi.h>
+#include <driver/gpio.h>
+
+IdleManager idleManager;
+
+static TaskHandle_t loopTask = nullptr;
+
+static void IRAM_ATTR wakeISR()
+{
+    IdleManager::wakeFromISR();
+}
+
+void IRAM_ATTR IdleManager::wakeFromISR()
+{
+    if (loopTask == nullptr)
+        return;
+
+    BaseType_t higherPriorityWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(loopTask, &higherPriorityWoken);
+    if (higherPriorityWoken)
+        portYIELD_FROM_ISR();
+}
+
+IdleManager::IdleManager() : wakePinCount(0),
+                             relaxedPowerSave(false),
+                             autoLightSleep(false),
+                             noSleepLock(nullptr),
+                             idleUs(0),
+                             sleepUs(0),
+                             windowStartUs(0),
+                             lightSleepCount(0)
+{
+}
+
+void IdleManager::begin()
+{
+    loopTask = xTaskGetCurrentTaskHandle();
+    windowStartUs = esp_timer_get_time();
+    relaxedPowerSave = false;
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+
+    // A manual esp_light_sleep_start() drops the WiFi connection, automatic
+    // light sleep keeps it. The lock keeps the chip awake (and the edge ISRs
+    // working) everywhere except inside lightSleep(). No frequency scaling.
+    esp_pm_config_esp32_t pmConfig = {};
+    pmConfig.max_freq_mhz = getCpuFrequencyMhz();
+    pmConfig.min_freq_mhz = getCpuFrequencyMhz();
+    pmConfig.light_sleep_enable = true;
+
+    autoLightSleep = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "idle", &noSleepLock) == ESP_OK &&
+                     esp_pm_lock_acquire(noSleepLock) == ESP_OK &&
+                     esp_pm_configure(&pmConfig) == ESP_OK;
+    if (!autoLightSleep)
+    {
+        Serial.println("Automatic light sleep unavailable, idling in modem sleep only");
+    }
+}
+
+void IdleManager::addWakePin(uint8_t pin, bool attachWakeISR)
+{
+    if (wakePinCount >= MAX_WAKE_PINS)
+        return;
+
+    wakePins[wakePinCount++] = pin;
+    if (attachWakeISR)
+    {
+        attachInterrupt(digitalPinToInterrupt(pin), wakeISR, CHANGE);
+    }
+}
+
+void IdleManager::setPowerSave(bool relaxed)
+{
+    if (relaxed == relaxedPowerSave)
+        return;
+
+    // Max modem sleep skips DTIM beacons; fine between 30 s paused polls
+    relaxedPowerSave = relaxed;
+    esp_wifi_set_ps(relaxed ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM);
+}
+
+void IdleManager::idleFor(unsigned long ms, bool allowLightSleep)
+{
+    if (ms == 0)
+        return;
+
+    int64_t start = esp_timer_get_time();
+
+    if (allowLightSleep && autoLightSleep && ms >= LIGHT_SLEEP_MIN_MS)
+    {
+        lightSleep(ms);
+        sleepUs += esp_timer_get_time() - start;
+        return;
+    }
+
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+    idleUs += esp_timer_get_time() - start;
+}
+
+void IdleManager::lightSleep(unsigned long ms)
+{
+    // Level wakeups replace the pins' edge interrupt type, and a level ISR
+    // would fire nonstop while a button is held, so the ISRs are off while armed
+    for (int i = 0; i < wakePinCount; i++)
+    {
+        gpio_num_t pin = (gpio_num_t)wakePins[i];
+        wakeLevels[i] = digitalRead(wakePins[i]);
+        gpio_intr_disable(pin);
+        gpio_wakeup_enable(pin, wakeLevels[i] ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    }
+    esp_sleep_enable_gpio_wakeup();
+
+    Serial.flush();
+    esp_pm_lock_release(noSleepLock);
+    lightSleepCount++;
+
+    // Nothing notifies this task with the ISRs off; a GPIO wakeup ends the
+    // light sleep and the next check sees the pin
+    unsigned long start = millis();
+    bool changed = false;
+    while (!changed && millis() - start < ms)
+    {
+        unsigned long slice = min(ms - (millis() - start), WAKE_POLL_MS);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(slice));
+        for (int i = 0; i < wakePinCount && !changed; i++)
+        {
+            changed = digitalRead(wakePins[i]) != wakeLevels[i];
+        }
+    }
+
+    esp_pm_lock_acquire(noSleepLock);
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+
+    // Edge mode goes back before the ISRs do. The edges missed meanwhile are
+    // queued by hand so the gesture decoder still sees the press.
+    uint32_t nowUs = micros();
+    for (int i = 0; i < wakePinCount; i++)
+    {
+        gpio_num_t pin = (gpio_num_t)wakePins[i];
+        gpio_wakeup_disable(pin);
+        gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+
+        int level = digitalRead(wakePins[i]);
+        if (level != wakeLevels[i])
+        {
+            InputEvent event = {wakePins[i], (uint8_t)(level == LOW ? EDGE_PRESS : EDGE_RELEASE), nowUs};
+            inputRing.push(event);
+        }
+    }
+
+    // Only now, the ring takes one producer at a time
+    for (int i = 0; i < wakePinCount; i++)
+    {
+        gpio_intr_enable((gpio_num_t)wakePins[i]);
+    }
+}
+
+void IdleManager::report()
+{
+    uint64_t now = esp_timer_get_time();
+    uint64_t window = now - windowStartUs;
+    if (window < (uint64_t)REPORT_INTERVAL * 1000)
+        return;
+
+    float idleShare = (float)idleUs / window;
+    float sleepShare = (float)sleepUs / window;
+    float activeShare = max(0.0f, 1.0f - idleShare - sleepShare);
+    float averageMa = activeShare * ACTIVE_MA + idleShare * IDLE_MA + sleepShare * LIGHT_SLEEP_MA;
+
+    Serial.printf("Idle: %.1f%% idle, %.1f%% light sleep (%lu sleeps), est. %.1f mA average\n",
+                  idleShare * 100, sleepShare * 100, lightSleepCount, averageMa);
+
+    windowStartUs = now;
+    idleUs = 0;
+    sleepUs = 0;
+    lightSleepCount = 0;
+}
@@ -0,0 +1,58 @@
+#ifndef IDLEMANAGER_H
+#define IDLEMANAGER_H
+
+#include <Arduino.h>
+#include <esp_pm.h>
+
+// Puts the main loop to sleep between events. Short waits block on a task
+// notification (CPU idles, WiFi in modem sleep). Long waits let the power
+// manager enter automatic light sleep, which keeps the WiFi association by
+// waking for beacons; GPIO level wakeups on the input pins end the wait.
+class IdleManager
+{
+public:
+    static const int MAX_WAKE_PINS = 8;
+    static const unsigned long LIGHT_SLEEP_MIN_MS = 250; // Shorter waits are not worth the wake-up cost
+    static const unsigned long WAKE_POLL_MS = 20;        // Pin check interval while the edge ISRs are off
+    static const unsigned long REPORT_INTERVAL = 60000;
+
+    // Rough ESP32 supply current per state for the estimate (mA)
+    static constexpr float ACTIVE_MA = 100.0f;
+    static constexpr float IDLE_MA = 30.0f;
+    static constexpr float LIGHT_SLEEP_MA = 1.5f;
+
+    IdleManager();
+
+    void begin();
+
+    // Pins that end a light sleep wait. Pins without their own ISR get a wake-only one.
+    void addWakePin(uint8_t pin, bool attachWakeISR);
+
+    // Deeper WiFi power save while nothing is playing, lower latency otherwise
+    void setPowerSave(bool relaxed);
+
+    // Wait up to ms, returning early when an ISR calls wakeFromISR()
+    void idleFor(unsigned long ms, bool allowLightSleep);
+
+    void report();
+
+    static void wakeFromISR();
+
+private:
+    void lightSleep(unsigned long ms);
+
+    uint8_t wakePins[MAX_WAKE_PINS];
+    int wakeLevels[MAX_WAKE_PINS]; // Pin levels when the wakeups were armed
+    int wakePinCount;
+    bool relaxedPowerSave;
+    bool autoLightSleep;              // The power manager accepted light_sleep_enable
+    esp_pm_lock_handle_t noSleepLock; // Held except during light sleep waits
+    uint64_t idleUs;
+    uint64_t sleepUs;
+    uint64_t windowStartUs;
+    unsigned long lightSleepCount;
+};
+
+extern IdleManager idleManager;
+
+#endif
@@ -0,0 +1,229 @@
+#include "inputEvents.h"
+#include "idleManager.h"
+
+InputRing inputRing;
+
+// Timestamp every edge; the level read here decides press vs release
+static void IRAM_ATTR inputISR(void *arg)
+{
+    uint8_t pin = (uint8_t)(uintptr_t)arg;
+    InputEvent event = {pin, (uint8_t)(digitalRead(pin) == LOW ? EDGE_PRESS : EDGE_RELEASE), (uint32_t)micros()};
+    inputRing.push(event);
+    IdleManager::wakeFromISR();
+}
+
+InputRing::InputRing() : head(0),
+                         tail(0),
+                         dropped(0)
+{
+}
+
+bool IRAM_ATTR InputRing::push(const InputEvent &event)
+{
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= SIZE)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    events[h & (SIZE - 1)] = event;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool InputRing::pop(InputEvent &event)
+{
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    event = events[t & (SIZE - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+GestureDetector::GestureDetector() : buttonCount(0),
+                                     queueHead(0),
+                                     queueCount(0)
+{
+}
+
+int GestureDetector::addButton(uint8_t pin, bool detectLong, bool detectDouble)
+{
+    if (buttonCount >= MAX_BUTTONS)
+    {
+        return -1;
+    }
+
+    ButtonState &button = buttons[buttonCount];
+    button.pin = pin;
+    button.detectLong = detectLong;
+    button.detectDouble = detectDouble;
+    button.down = false;
+    button.longFired = false;
+    button.clicks = 0;
+    button.lastEdgeUs = 0;
+    button.pressUs = 0;
+    button.releaseUs = 0;
+    return buttonCount++;
+}
+
+void GestureDetector::begin()
+{
+    for (int i = 0; i < buttonCount; i++)
+    {
+        pinMode(buttons[i].pin, INPUT_PULLUP);
+        buttons[i].down = digitalRead(buttons[i].pin) == LOW;
+        attachInterruptArg(digitalPinToInterrupt(buttons[i].pin), inputISR, (void *)(uintptr_t)buttons[i].pin, CHANGE);
+    }
+}
+
+bool GestureDetector::busy() const
+{
+    for (int i = 0; i < buttonCount; i++)
+    {
+        if (buttons[i].down || buttons[i].clicks > 0)
+            return true;
+    }
+    return false;
+}
+
+bool GestureDetector::held(int button) const
+{
+    return button >= 0 && button < buttonCount && buttons[button].down;
+}
+
+void GestureDetector::consume(int button)
+{
+    if (button < 0 || button >= buttonCount)
+    {
+        return;
+    }
+
+    buttons[button].longFired = true;
+    buttons[button].clicks = 0;
+}
+
+bool GestureDetector::next(Gesture &gesture)
+{
+    InputEvent event;
+    while (inputRing.pop(event))
+    {
+        process(event);
+    }
+    checkTimers(micros());
+
+    if (queueCount == 0)
+    {
+        return false;
+    }
+
+    gesture = queue[queueHead];
+    queueHead = (queueHead + 1) % QUEUE_SIZE;
+    queueCount--;
+    return true;
+}
+
+void GestureDetector::process(const InputEvent &event)
+{
+    for (int i = 0; i < buttonCount; i++)
+    {
+        if (buttons[i].pin != event.pin)
+            continue;
+
+        ButtonState &button = buttons[i];
+        bool pressed = event.edge == EDGE_PRESS;
+
+        // Contact bounce: ignore repeats and edges inside the lockout window
+        if (pressed == button.down || event.timeUs - button.lastEdgeUs < DEBOUNCE_US)
+            return;
+
+        applyEdge(i, pressed, event.timeUs);
+        return;
+    }
+}
+
+void GestureDetector::applyEdge(int index, bool pressed, uint32_t timeUs)
+{
+    ButtonState &button = buttons[index];
+    button.down = pressed;
+    button.lastEdgeUs = timeUs;
+
+    if (pressed)
+    {
+        button.pressUs = timeUs;
+        button.longFired = false;
+
+        // Plain buttons act on the press edge for the lowest latency
+        if (!button.detectLong && !button.detectDouble)
+        {
+            emit(index, GESTURE_SHORT, timeUs);
+        }
+        return;
+    }
+
+    if (button.longFired || (!button.detectLong && !button.detectDouble))
+    {
+        return;
+    }
+
+    if (!button.detectDouble)
+    {
+        emit(index, GESTURE_SHORT, timeUs);
+        return;
+    }
+
+    button.clicks++;
+    button.releaseUs = timeUs;
+    if (button.clicks >= 2)
+    {
+        button.clicks = 0;
+        emit(index, GESTURE_DOUBLE, timeUs);
+    }
+}
+
+void GestureDetector::checkTimers(uint32_t nowUs)
+{
+    for (int i = 0; i < buttonCount; i++)
+    {
+        ButtonState &button = buttons[i];
+
+        // An edge lost inside the debounce window leaves the state stale, resync from the pin
+        if (nowUs - button.lastEdgeUs >= DEBOUNCE_US)
+        {
+            bool pressed = digitalRead(button.pin) == LOW;
+            if (pressed != button.down)
+            {
+                applyEdge(i, pressed, nowUs);
+            }
+        }
+
+        if (button.down && button.detectLong && !button.longFired && nowUs - button.pressUs >= LONG_PRESS_US)
+        {
+            button.longFired = true;
+            button.clicks = 0;
+            emit(i, GESTURE_LONG, nowUs);
+        }
+
+        if (!button.down && button.clicks == 1 && nowUs - button.releaseUs >= DOUBLE_PRESS_US)
+        {
+            button.clicks = 0;
+            emit(i, GESTURE_SHORT, button.releaseUs);
+        }
+    }
+}
+
+void GestureDetector::emit(uint8_t button, GestureType type, uint32_t timeUs)
+{
+    if (queueCount >= QUEUE_SIZE)
+    {
+        Serial.println("Gesture queue full, dropping input");
+        return;
+    }
+
+    queue[(queueHead + queueCount) % QUEUE_SIZE] = {button, type, timeUs};
+    queueCount++;
+}
@@ -0,0 +1,112 @@
+#ifndef INPUTEVENTS_H
+#define INPUTEVENTS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Raw edge captured by a button ISR
+enum InputEdge : uint8_t
+{
+    EDGE_PRESS,
+    EDGE_RELEASE
+};
+
+struct InputEvent
+{
+    uint8_t pin;
+    uint8_t edge;
+    uint32_t timeUs;
+};
+
+// Single-producer (GPIO ISRs) / single-consumer (loop) lock-free ring
+class InputRing
+{
+public:
+    static const uint32_t SIZE = 32; // Must be a power of two
+
+    InputRing();
+
+    bool push(const InputEvent &event);
+    bool pop(InputEvent &event);
+    bool empty() const { return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire); }
+    uint32_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    InputEvent events[SIZE];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> dropped;
+};
+
+enum GestureType : uint8_t
+{
+    GESTURE_SHORT,
+    GESTURE_LONG,
+    GESTURE_DOUBLE
+};
+
+struct Gesture
+{
+    uint8_t button;
+    GestureType type;
+    uint32_t timeUs; // Edge time that completed the gesture
+};
+
+// Debounces ring events per button and turns them into short/long/double presses
+class GestureDetector
+{
+public:
+    static const int MAX_BUTTONS = 4;
+    static const int QUEUE_SIZE = 16;
+    static const uint32_t DEBOUNCE_US = 20000;
+    static const uint32_t LONG_PRESS_US = 600000;
+    static const uint32_t DOUBLE_PRESS_US = 300000;
+
+    GestureDetector();
+
+    // Buttons are active low with pull-ups; returns the button index
+    int addButton(uint8_t pin, bool detectLong, bool detectDouble);
+    void begin();
+
+    // Drain the ring and return the next completed gesture, if any
+    bool next(Gesture &gesture);
+
+    // True while a press or a double-press window still needs timing
+    bool busy() const;
+
+    // Button currently held down
+    bool held(int button) const;
+
+    // The current press was used for something else (hold and turn): its
+    // release emits nothing and no long press follows
+    void consume(int button);
+
+private:
+    struct ButtonState
+    {
+        uint8_t pin;
+        bool detectLong;
+        bool detectDouble;
+        bool down;
+        bool longFired;
+        uint8_t clicks;
+        uint32_t lastEdgeUs;
+        uint32_t pressUs;
+        uint32_t releaseUs;
+    };
+
+    void process(const InputEvent &event);
+    void applyEdge(int index, bool pressed, uint32_t timeUs);
+    void checkTimers(uint32_t nowUs);
+    void emit(uint8_t button, GestureType type, uint32_t timeUs);
+
+    ButtonState buttons[MAX_BUTTONS];
+    int buttonCount;
+    Gesture queue[QUEUE_SIZE];
+    int queueHead;
+    int queueCount;
+};
+
+extern InputRing inputRing;
+
+#endif
@@ -0,0 +1,96 @@
+#include "jsonPool.h"
+
+ArenaAllocator::ArenaAllocator(uint8_t *buffer, size_t capacity) : buffer(buffer),
+                                                                   size(capacity),
+                                                                   offset(0),
+                                                                   lastBlock(SIZE_MAX),
+                                                                   peakUsed(0)
+{
+}
+
+void *ArenaAllocator::allocate(size_t blockSize)
+{
+    size_t aligned = (blockSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (offset + HEADER + aligned > size)
+    {
+        return nullptr; // ArduinoJson reports NoMemory
+    }
+
+    *(size_t *)(buffer + offset) = blockSize;
+    lastBlock = offset;
+    offset += HEADER + aligned;
+    peakUsed = max(peakUsed, offset);
+    return buffer + lastBlock + HEADER;
+}
+
+void ArenaAllocator::deallocate(void *ptr)
+{
+    // Space comes back on reset(), except for the most recent block
+    if (ptr != nullptr && (uint8_t *)ptr - HEADER == buffer + lastBlock)
+    {
+        offset = lastBlock;
+        lastBlock = SIZE_MAX;
+    }
+}
+
+void *ArenaAllocator::reallocate(void *ptr, size_t newSize)
+{
+    if (ptr == nullptr)
+    {
+        return allocate(newSize);
+    }
+
+    uint8_t *block = (uint8_t *)ptr - HEADER;
+    size_t oldSize = *(size_t *)block;
+
+    // The last block can grow or shrink in place (shrinkToFit after parsing)
+    if (block == buffer + lastBlock)
+    {
+        size_t aligned = (newSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        if (lastBlock + HEADER + aligned > size)
+        {
+            return nullptr;
+        }
+        *(size_t *)block = newSize;
+        offset = lastBlock + HEADER + aligned;
+        peakUsed = max(peakUsed, offset);
+        return ptr;
+    }
+
+    if (newSize <= oldSize)
+    {
+        return ptr;
+    }
+
+    void *moved = allocate(newSize);
+    if (moved != nullptr)
+    {
+        memcpy(moved, ptr, oldSize);
+    }
+    return moved;
+}
+
+void ArenaAllocator::reset()
+{
+    offset = 0;
+    lastBlock = SIZE_MAX;
+}
+
+JsonPool::JsonPool(uint8_t *buffer, size_t capacity, const char *name) : arena(buffer, capacity),
+                                                                           document(&arena),
+                                                                           name(name),
+                                                                           reportedPeak(0)
+{
+}
+
+void JsonPool::release()
+{
+    document.clear();
+    arena.reset();
+
+    if (arena.peak() > reportedPeak)
+    {
+        reportedPeak = arena.peak();
+        Serial.printf("JSON pool %s: peak %u of %u bytes\n", name, (unsigned)reportedPeak, (unsigned)arena.capacity());
+    }
+}
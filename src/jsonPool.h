@@ -0,0 +1,65 @@
+#ifndef JSONPOOL_H
+#define JSONPOOL_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Bump allocator over a static buffer. Nothing is freed individually; the
+// whole arena is reset once the document that used it has been consumed.
+class ArenaAllocator : public ArduinoJson::Allocator
+{
+public:
+    ArenaAllocator(uint8_t *buffer, size_t capacity);
+
+    void *allocate(size_t size) override;
+    void deallocate(void *ptr) override;
+    void *reallocate(void *ptr, size_t newSize) override;
+
+    void reset();
+    size_t used() const { return offset; }
+    size_t peak() const { return peakUsed; }
+    size_t capacity() const { return size; }
+
+private:
+    static const size_t ALIGNMENT = 8;
+    static const size_t HEADER = ALIGNMENT; // Block size, kept aligned
+
+    uint8_t *buffer;
+    size_t size;
+    size_t offset;
+    size_t lastBlock;
+    size_t peakUsed;
+};
+
+// JsonDocument bound to its own arena, reused for every parse of one endpoint
+class JsonPool
+{
+public:
+    JsonPool(uint8_t *buffer, size_t capacity, const char *name);
+
+    JsonDocument &doc() { return document; }
+
+    // Drop the parsed data and rewind the arena; logs new high-water marks
+    void release();
+
+private:
+    ArenaAllocator arena;
+    JsonDocument document;
+    const char *name;
+    size_t reportedPeak;
+};
+
+// Releases a pool when leaving scope, so early returns cannot leak the arena
+class JsonPoolLease
+{
+public:
+    explicit JsonPoolLease(JsonPool &pool) : pool(pool) {}
+    ~JsonPoolLease() { pool.release(); }
+
+    JsonDocument &doc() { return pool.doc(); }
+
+private:
+    JsonPool &pool;
+};
+
+#endif
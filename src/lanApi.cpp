@@ -0,0 +1,407 @@
+#include "lanApi.h"
+#include "secrets.h"
+#include "spotifyClient.h"
+#include "jsonPool.h"
+#include <WebsocketNode.hpp>
+
+LanApi lanApi;
+
+// One ArduinoJson variant pool (about 1 KB on the ESP32) plus the copied
+// track strings at full length; the pool logs its peak on first use
+static uint8_t apiArena[2048] __attribute__((aligned(8)));
+static JsonPool apiPool(apiArena, sizeof(apiArena), "api");
+static char eventBuffer[768];
+
+// Constant time, so the token cannot be guessed byte by byte from the timing
+static bool tokenMatches(const std::string &given)
+{
+#ifdef LAN_API_TOKEN
+    static const char token[] = LAN_API_TOKEN;
+    size_t length = sizeof(token) - 1;
+    if (length == 0 || given.length() != length)
+    {
+        return false;
+    }
+
+    uint8_t diff = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        diff |= given[i] ^ token[i];
+    }
+    return diff == 0;
+#else
+    (void)given;
+    return false;
+#endif
+}
+
+static void sendJson(HTTPResponse *res, int statusCode, const char *statusText, const char *body, size_t length)
+{
+    res->setStatusCode(statusCode);
+    res->setStatusText(statusText);
+    res->setHeader("Content-Type", "application/json");
+    res->setHeader("Content-Length", std::to_string(length));
+    res->setHeader("Cache-Control", "no-store");
+    res->write((uint8_t *)body, length);
+}
+
+static void sendError(HTTPResponse *res, int statusCode, const char *statusText)
+{
+    char body[64];
+    int length = snprintf(body, sizeof(body), "{\"error\":\"%s\"}", statusText);
+    sendJson(res, statusCode, statusText, body, length);
+}
+
+// A document that ran out of arena, or would not fit its output buffer,
+// would go out truncated
+static bool fits(const JsonDocument &doc, size_t bufferSize)
+{
+    if (doc.overflowed() || measureJson(doc) >= bufferSize)
+    {
+        Serial.println("LAN API: document too large, not sent");
+        return false;
+    }
+    return true;
+}
+
+// Track fields, shared by the state snapshot and track change events
+static void fillTrack(JsonDocument &doc)
+{
+    const SongDetails &song = spotifyConnection.getCurrentSong();
+    doc["song"] = song.song.c_str();
+    doc["artist"] = song.artist.c_str();
+    doc["album"] = song.album.c_str();
+    doc["id"] = song.Id.c_str();
+    doc["liked"] = song.isLiked;
+    doc["durationMs"] = song.durationMs;
+}
+
+// Snapshot of the cached playback state, no upstream request involved
+static void fillState(JsonDocument &doc)
+{
+    doc["active"] = spotifyConnection.getActiveStatus();
+    doc["playing"] = spotifyConnection.getStatus();
+    fillTrack(doc);
+    doc["positionMs"] = (long)spotifyConnection.getCurrentPositionMs();
+    doc["volume"] = spotifyConnection.currVol;
+    doc["volumeSupported"] = spotifyConnection.volCtrl;
+    doc["ageMs"] = millis() - spotifyConnection.lastTrackInfoTime;
+}
+
+static void sendState(HTTPResponse *res, int statusCode, const char *statusText)
+{
+    static char body[768];
+
+    JsonPoolLease lease(apiPool);
+    JsonDocument &doc = lease.doc();
+    fillState(doc);
+    if (!fits(doc, sizeof(body)))
+    {
+        sendError(res, 500, "Internal Server Error");
+        return;
+    }
+
+    size_t length = serializeJson(doc, body, sizeof(body));
+    sendJson(res, statusCode, statusText, body, length);
+}
+
+static void handleApiState(HTTPRequest *req, HTTPResponse *res)
+{
+    lanApi.countRequest();
+    if (!spotifyConnection.accessTokenSet)
+    {
+        sendError(res, 503, "Service Unavailable");
+        return;
+    }
+
+    // Read-only, so browser dashboards on any origin may fetch it
+    res->setHeader("Access-Control-Allow-Origin", "*");
+    sendState(res, 200, "OK");
+}
+
+// Commands are queued like button presses and flushed from loop()
+static void handleApiCommand(HTTPRequest *req, HTTPResponse *res)
+{
+    lanApi.countRequest();
+    req->discardRequestBody();
+
+    if (!tokenMatches(req->getHeader("X-Api-Token")))
+    {
+        sendError(res, 403, "Forbidden");
+        return;
+    }
+
+    if (!spotifyConnection.accessTokenSet)
+    {
+        sendError(res, 503, "Service Unavailable");
+        return;
+    }
+
+    std::string command;
+    req->getParams()->getPathParameter(0, command);
+
+    if (command == "play" || command == "pause")
+    {
+        if (spotifyConnection.isPlaying != (command == "play"))
+        {
+            spotifyConnection.togglePlay();
+        }
+    }
+    else if (command == "toggle")
+    {
+        spotifyConnection.togglePlay();
+    }
+    else if (command == "next")
+    {
+        spotifyConnection.skipForward();
+    }
+    else if (command == "previous")
+    {
+        spotifyConnection.skipBack();
+    }
+    else if (command == "like")
+    {
+        spotifyConnection.toggleLiked();
+    }
+    else if (command == "volume")
+    {
+        std::string value;
+        if (!req->getParams()->getQueryParameter("value", value))
+        {
+            sendError(res, 400, "Bad Request");
+            return;
+        }
+        if (!spotifyConnection.volCtrl)
+        {
+            sendError(res, 409, "Conflict");
+            return;
+        }
+        spotifyConnection.setVolumeTarget(atoi(value.c_str()));
+    }
+    else if (command == "seek")
+    {
+        std::string value;
+        if (!req->getParams()->getQueryParameter("value", value))
+        {
+            sendError(res, 400, "Bad Request");
+            return;
+        }
+        spotifyConnection.seekTo(atoi(value.c_str()));
+    }
+    else
+    {
+        sendError(res, 404, "Not Found");
+        return;
+    }
+
+    spotifyConnection.requestTrackInfo();
+    sendState(res, 202, "Accepted");
+}
+
+// -------- EVENTS --------
+// The server creates the handler only after a successful handshake, so a
+// full subscriber list has to refuse the upgrade itself. The client gets a
+// 503 instead of a socket that never sees an event.
+static void limitSubscribers(HTTPRequest *req, HTTPResponse *res, std::function<void()> next)
+{
+    if (req->getRequestString().rfind("/api/events", 0) == 0 && !lanApi.hasSubscriberSlot())
+    {
+        Serial.println("Too many event subscribers, refusing");
+        req->discardRequestBody();
+        sendError(res, 503, "Service Unavailable");
+        return;
+    }
+    next();
+}
+
+// One per WebSocket subscriber; clients only listen
+class EventsHandler : public WebsocketHandler
+{
+public:
+    static WebsocketHandler *create()
+    {
+        EventsHandler *handler = new EventsHandler();
+        lanApi.subscribe(handler); // limitSubscribers() kept a slot free
+        return handler;
+    }
+
+    void onMessage(WebsocketInputStreambuf *input) override {}
+    void onClose() override { lanApi.unsubscribe(this); }
+};
+
+LanApi::LanApi() : subscriberCount(0),
+                   lastPositionTick(0),
+                   events(0),
+                   requests(0),
+                   lastReport(0)
+{
+    sent.active = false;
+    sent.playing = false;
+    sent.volume = -1;
+    sent.liked = false;
+}
+
+void LanApi::begin(HTTPSServer *server)
+{
+    server->registerNode(new ResourceNode("/api/state", "GET", &handleApiState));
+    server->registerNode(new ResourceNode("/api/*", "POST", &handleApiCommand));
+    server->registerNode(new WebsocketNode("/api/events", &EventsHandler::create));
+    server->addMiddleware(&limitSubscribers);
+    lastReport = millis();
+
+#ifndef LAN_API_TOKEN
+    Serial.println("LAN API: no LAN_API_TOKEN in secrets.h, commands are refused");
+#endif
+}
+
+bool LanApi::subscribe(WebsocketHandler *handler)
+{
+    if (subscriberCount >= MAX_SUBSCRIBERS)
+    {
+        return false;
+    }
+
+    // The snapshot goes out from the next publish(), once the handshake is done
+    subscribers[subscriberCount] = handler;
+    needsSnapshot[subscriberCount] = true;
+    subscriberCount++;
+    return true;
+}
+
+void LanApi::unsubscribe(WebsocketHandler *handler)
+{
+    for (int i = 0; i < subscriberCount; i++)
+    {
+        if (subscribers[i] == handler)
+        {
+            subscriberCount--;
+            subscribers[i] = subscribers[subscriberCount];
+            needsSnapshot[i] = needsSnapshot[subscriberCount];
+            return;
+        }
+    }
+}
+
+// Serialize once, then hand the same bytes to every subscriber
+void LanApi::broadcast(JsonDocument &doc)
+{
+    if (!fits(doc, sizeof(eventBuffer)))
+    {
+        return;
+    }
+
+    size_t length = serializeJson(doc, eventBuffer, sizeof(eventBuffer));
+
+    for (int i = 0; i < subscriberCount; i++)
+    {
+        if (!needsSnapshot[i])
+        {
+            subscribers[i]->send((uint8_t *)eventBuffer, length, WebsocketHandler::SEND_TYPE_TEXT);
+        }
+    }
+    events++;
+}
+
+void LanApi::publish()
+{
+    if (subscriberCount == 0)
+    {
+        return;
+    }
+
+    const SongDetails &song = spotifyConnection.getCurrentSong();
+    bool playing = spotifyConnection.getStatus();
+    unsigned long now = millis();
+
+    // -------- Deltas --------
+    if (sent.id != song.Id.c_str())
+    {
+        JsonPoolLease lease(apiPool);
+        JsonDocument &doc = lease.doc();
+        doc["type"] = "track";
+        fillTrack(doc);
+        broadcast(doc);
+        sent.id = song.Id;
+        sent.liked = song.isLiked;
+    }
+    else if (sent.liked != song.isLiked)
+    {
+        JsonPoolLease lease(apiPool);
+        JsonDocument &doc = lease.doc();
+        doc["type"] = "liked";
+        doc["liked"] = song.isLiked;
+        broadcast(doc);
+        sent.liked = song.isLiked;
+    }
+
+    if (sent.active != spotifyConnection.getActiveStatus())
+    {
+        JsonPoolLease lease(apiPool);
+        JsonDocument &doc = lease.doc();
+        doc["type"] = "active";
+        doc["active"] = spotifyConnection.getActiveStatus();
+        broadcast(doc);
+        sent.active = spotifyConnection.getActiveStatus();
+    }
+
+    if (sent.volume != spotifyConnection.currVol)
+    {
+        JsonPoolLease lease(apiPool);
+        JsonDocument &doc = lease.doc();
+        doc["type"] = "volume";
+        doc["volume"] = spotifyConnection.currVol;
+        broadcast(doc);
+        sent.volume = spotifyConnection.currVol;
+    }
+
+    // Clients interpolate between position ticks themselves
+    if (sent.playing != playing || (playing && now - lastPositionTick >= POSITION_TICK))
+    {
+        JsonPoolLease lease(apiPool);
+        JsonDocument &doc = lease.doc();
+        doc["type"] = sent.playing != playing ? "playing" : "position";
+        doc["playing"] = playing;
+        doc["positionMs"] = (long)spotifyConnection.getCurrentPositionMs();
+        broadcast(doc);
+        sent.playing = playing;
+        lastPositionTick = now;
+    }
+
+    // -------- Snapshots for new subscribers --------
+    for (int i = 0; i < subscriberCount; i++)
+    {
+        if (!needsSnapshot[i])
+            continue;
+
+        JsonPoolLease lease(apiPool);
+        JsonDocument &doc = lease.doc();
+        doc["type"] = "state";
+        fillState(doc);
+        needsSnapshot[i] = false;
+        if (!fits(doc, sizeof(eventBuffer)))
+            continue;
+
+        size_t length = serializeJson(doc, eventBuffer, sizeof(eventBuffer));
+        subscribers[i]->send((uint8_t *)eventBuffer, length, WebsocketHandler::SEND_TYPE_TEXT);
+    }
+}
+
+// Requests per second served, for load testing over serial
+void LanApi::report()
+{
+    unsigned long now = millis();
+    if (now - lastReport < REPORT_INTERVAL)
+        return;
+
+    if (requests > 0)
+    {
+        Serial.printf("LAN API: %lu requests, %.1f req/s\n", requests, requests * 1000.0f / (now - lastReport));
+    }
+    if (events > 0)
+    {
+        Serial.printf("LAN API: %lu events to %d subscribers\n", events, subscriberCount);
+    }
+    requests = 0;
+    events = 0;
+    lastReport = now;
+}
@@ -0,0 +1,81 @@
+#ifndef LANAPI_H
+#define LANAPI_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <HTTPSServer.hpp>
+#include <WebsocketHandler.hpp>
+#include "fixedString.h"
+
+// Keep the HTTPS server running after login and serve the control API.
+// Off by default: the server is polled every POLL_INTERVAL, so the loop
+// wakes 50 times a second and never enters light sleep while paused; the
+// CPU then idles at full clock instead of sleeping between WiFi beacons.
+#ifndef LAN_API
+#define LAN_API false
+#endif
+
+// Commands must carry LAN_API_TOKEN (defined in secrets.h) in an X-Api-Token
+// header. A custom header cannot be sent cross-origin without a CORS
+// preflight, which the server never grants, so a web page opened on the LAN
+// cannot drive playback. Without a token all commands are refused.
+
+using namespace httpsserver;
+
+// REST API for other devices on the LAN. State is answered from the cached
+// playback snapshot, so any number of clients costs no extra Spotify
+// requests; commands go through the same queues as the buttons.
+//
+//   GET  /api/state
+//   POST /api/play, /api/pause, /api/toggle, /api/next, /api/previous,
+//        /api/like, /api/volume?value=0..100, /api/seek?value=ms
+//        (with an X-Api-Token: LAN_API_TOKEN header, 403 if none is set)
+//   WS   /api/events  (state snapshot on connect, then only changes)
+class LanApi
+{
+public:
+    static const unsigned long POLL_INTERVAL = 20;     // Max idle time while serving, the server is polled
+    static const unsigned long REPORT_INTERVAL = 30000;
+    static const unsigned long POSITION_TICK = 1000;   // Position event interval while playing
+    static const int MAX_SUBSCRIBERS = 4;              // The server takes 4 connections at most
+
+    LanApi();
+
+    void begin(HTTPSServer *server);
+    void report();
+
+    // Push what changed since the last call to every event subscriber
+    void publish();
+
+    // Called by the handlers
+    void countRequest() { requests++; }
+    bool hasSubscriberSlot() const { return subscriberCount < MAX_SUBSCRIBERS; }
+    bool subscribe(WebsocketHandler *handler);
+    void unsubscribe(WebsocketHandler *handler);
+
+private:
+    // What subscribers were last told
+    struct Snapshot
+    {
+        bool active;
+        bool playing;
+        int volume;
+        bool liked;
+        FixedString<23> id;
+    };
+
+    void broadcast(JsonDocument &doc);
+
+    WebsocketHandler *subscribers[MAX_SUBSCRIBERS];
+    bool needsSnapshot[MAX_SUBSCRIBERS];
+    int subscriberCount;
+    Snapshot sent;
+    unsigned long lastPositionTick;
+    unsigned long events;
+    unsigned long requests;
+    unsigned long lastReport;
+};
+
+extern LanApi lanApi;
+
+#endif
@@ -0,0 +1,154 @@
+#include "latencyTrace.h"
+
+LatencyTracer latencyTracer;
+
+static const char *commandNames[TRACE_CMD_COUNT] = {"play", "next", "prev", "like", "volume"};
+
+LatencyTracer::LatencyTracer() : active(false),
+                                 traceId(0),
+                                 command(TRACE_CMD_PLAY),
+                                 newSamples(false),
+                                 lastReport(0)
+{
+    memset(stageUs, 0, sizeof(stageUs));
+    memset(stageSeen, 0, sizeof(stageSeen));
+    memset(samples, 0, sizeof(samples));
+}
+
+uint16_t LatencyTracer::begin(TraceCommand cmd, uint32_t inputUs)
+{
+    if (active)
+    {
+        Serial.printf("Trace #%u dropped, superseded by new input\n", traceId);
+    }
+
+    active = true;
+    traceId++;
+    command = cmd;
+    memset(stageSeen, 0, sizeof(stageSeen));
+    stageUs[TRACE_INPUT] = inputUs;
+    stageSeen[TRACE_INPUT] = true;
+    return traceId;
+}
+
+void LatencyTracer::mark(TraceStage stage)
+{
+    markAt(stage, micros());
+}
+
+void LatencyTracer::markAt(TraceStage stage, uint32_t us)
+{
+    if (!active || stageSeen[stage])
+    {
+        return;
+    }
+
+    if (us - stageUs[TRACE_INPUT] > TRACE_TIMEOUT_US)
+    {
+        Serial.printf("Trace #%u timed out\n", traceId);
+        active = false;
+        return;
+    }
+
+    // Only frames showing the command's result count
+    if ((stage == TRACE_DRAW || stage == TRACE_HANDOFF || stage == TRACE_FLUSH) && !stageSeen[TRACE_STATE_UPDATE])
+    {
+        return;
+    }
+    if (stage == TRACE_HANDOFF && !stageSeen[TRACE_DRAW])
+    {
+        return;
+    }
+    if (stage == TRACE_FLUSH && !stageSeen[TRACE_HANDOFF])
+    {
+        return;
+    }
+
+    stageUs[stage] = us;
+    stageSeen[stage] = true;
+
+    if (stageSeen[TRACE_FLUSH] && stageSeen[TRACE_FIRST_BYTE])
+    {
+        finish();
+    }
+}
+
+void LatencyTracer::finish()
+{
+    active = false;
+
+    uint32_t start = stageUs[TRACE_INPUT];
+    SampleSet &set = samples[command];
+    set.displayUs[set.next] = stageUs[TRACE_FLUSH] - start;
+    set.ackUs[set.next] = stageUs[TRACE_FIRST_BYTE] - start;
+    set.next = (set.next + 1) % SAMPLES;
+    if (set.count < SAMPLES)
+        set.count++;
+    newSamples = true;
+
+    Serial.printf("Trace #%u %s: dispatch %lu, sent %lu, ack %lu, state %lu, draw %lu, handoff %lu, flush %lu (ms)\n",
+                  traceId, commandNames[command],
+                  (unsigned long)(stageUs[TRACE_DISPATCH] - start) / 1000,
+                  stageSeen[TRACE_SENT] ? (unsigned long)(stageUs[TRACE_SENT] - start) / 1000 : 0UL,
+                  (unsigned long)(stageUs[TRACE_FIRST_BYTE] - start) / 1000,
+                  (unsigned long)(stageUs[TRACE_STATE_UPDATE] - start) / 1000,
+                  (unsigned long)(stageUs[TRACE_DRAW] - start) / 1000,
+                  (unsigned long)(stageUs[TRACE_HANDOFF] - start) / 1000,
+                  (unsigned long)(stageUs[TRACE_FLUSH] - start) / 1000);
+}
+
+LatencyPercentiles LatencyTracer::percentiles(const uint32_t *values, uint16_t count)
+{
+    LatencyPercentiles result = {count, 0, 0, 0};
+    if (count == 0)
+        return result;
+
+    uint32_t sorted[SAMPLES];
+    memcpy(sorted, values, count * sizeof(uint32_t));
+    std::sort(sorted, sorted + count);
+
+    result.p50Us = sorted[count * 50 / 100];
+    result.p95Us = sorted[count * 95 / 100];
+    result.p99Us = sorted[count * 99 / 100];
+    return result;
+}
+
+LatencyPercentiles LatencyTracer::displayLatency(TraceCommand cmd) const
+{
+    return percentiles(samples[cmd].displayUs, samples[cmd].count);
+}
+
+LatencyPercentiles LatencyTracer::spotifyLatency(TraceCommand cmd) const
+{
+    return percentiles(samples[cmd].ackUs, samples[cmd].count);
+}
+
+void LatencyTracer::printPercentiles(const char *label, const LatencyPercentiles &latency)
+{
+    Serial.printf("  %-8s p50 %lu ms, p95 %lu ms, p99 %lu ms\n", label,
+                  (unsigned long)latency.p50Us / 1000,
+                  (unsigned long)latency.p95Us / 1000,
+                  (unsigned long)latency.p99Us / 1000);
+}
+
+void LatencyTracer::report()
+{
+    if (!newSamples || millis() - lastReport < REPORT_INTERVAL)
+    {
+        return;
+    }
+    lastReport = millis();
+    newSamples = false;
+
+    Serial.println("Input latency:");
+    for (int i = 0; i < TRACE_CMD_COUNT; i++)
+    {
+        const SampleSet &set = samples[i];
+        if (set.count == 0)
+            continue;
+
+        Serial.printf(" %s (%u samples)\n", commandNames[i], set.count);
+        printPercentiles("display", displayLatency((TraceCommand)i));
+        printPercentiles("spotify", spotifyLatency((TraceCommand)i));
+    }
+}
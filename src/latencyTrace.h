@@ -0,0 +1,87 @@
+#ifndef LATENCYTRACE_H
+#define LATENCYTRACE_H
+
+#include <Arduino.h>
+#include <algorithm>
+
+enum TraceCommand : uint8_t
+{
+    TRACE_CMD_PLAY,
+    TRACE_CMD_NEXT,
+    TRACE_CMD_PREV,
+    TRACE_CMD_LIKE,
+    TRACE_CMD_VOLUME,
+    TRACE_CMD_COUNT
+};
+
+// Points an input passes through on its way to the screen and to Spotify
+enum TraceStage : uint8_t
+{
+    TRACE_INPUT,        // ISR edge
+    TRACE_DISPATCH,     // Picked up by the command handler
+    TRACE_SENT,         // Request written by HttpsSession
+    TRACE_FIRST_BYTE,   // First response byte from Spotify
+    TRACE_STATE_UPDATE, // Local playback state reflects the command
+    TRACE_DRAW,         // drawScreen() started rendering it
+    TRACE_HANDOFF,      // Frame handed to the display flush task
+    TRACE_FLUSH,        // Flush task finished sending that frame to the panel
+    TRACE_STAGE_COUNT
+};
+
+// Percentiles of one sample set, zero while it is empty
+struct LatencyPercentiles
+{
+    uint16_t count;
+    uint32_t p50Us;
+    uint32_t p95Us;
+    uint32_t p99Us;
+};
+
+// Follows one input at a time from ISR to display and reports p50/p95/p99
+// per command type over serial.
+class LatencyTracer
+{
+public:
+    static const int SAMPLES = 64;
+    static const uint32_t TRACE_TIMEOUT_US = 10000000;
+    static const unsigned long REPORT_INTERVAL = 30000;
+
+    LatencyTracer();
+
+    // Start tracing a command; returns its trace ID
+    uint16_t begin(TraceCommand command, uint32_t inputUs);
+    void mark(TraceStage stage);
+    // Record a stage that happened earlier, e.g. on another task
+    void markAt(TraceStage stage, uint32_t us);
+    void report();
+
+    // Input to frame on the panel, and input to Spotify's first response byte
+    LatencyPercentiles displayLatency(TraceCommand command) const;
+    LatencyPercentiles spotifyLatency(TraceCommand command) const;
+
+private:
+    struct SampleSet
+    {
+        uint32_t displayUs[SAMPLES];
+        uint32_t ackUs[SAMPLES];
+        uint16_t count;
+        uint16_t next;
+    };
+
+    void finish();
+    static LatencyPercentiles percentiles(const uint32_t *values, uint16_t count);
+    static void printPercentiles(const char *label, const LatencyPercentiles &latency);
+
+    bool active;
+    uint16_t traceId;
+    TraceCommand command;
+    uint32_t stageUs[TRACE_STAGE_COUNT];
+    bool stageSeen[TRACE_STAGE_COUNT];
+    SampleSet samples[TRACE_CMD_COUNT];
+    bool newSamples;
+    unsigned long lastReport;
+};
+
+extern LatencyTracer latencyTracer;
+
+#endif
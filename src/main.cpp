@@ -5,9 +5,21 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_SH110X.h>
 #include <ESP32Encoder.h>
-#include <ezButton.h>
 
 #include "spotifyClient.h"
+#include "oledDisplay.h"
+#include "widgets.h"
+#include "bitmaps.h"
+#include "pages.h"
+#include "inputEvents.h"
+#include "latencyTrace.h"
+#include "idleManager.h"
+#include "playlistBrowser.h"
+#include "lanApi.h"
+#include "multicastSync.h"
+#include "soakTest.h"
+#include "requestScheduler.h"
+#include "dnsCache.h"
 
 // Pin Definitions
 #define PREV_BTN_PIN 5
@@ -24,193 +36,432 @@
 #define OLED_RESET -1
 
 // Objects
-Adafruit_SH1106G display = Adafruit_SH1106G(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+OledDisplay display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET, OLED_I2C_CLOCK);
 ESP32Encoder encoder;
 
-ezButton prevBtn(PREV_BTN_PIN);
-ezButton playBtn(PLAY_BTN_PIN);
-ezButton nextBtn(NEXT_BTN_PIN);
-ezButton encSwBtn(ENC_SW_PIN);
+GestureDetector inputs;
 
-// Timing variables
-unsigned long lastApiRefresh = 0;
-
-// Interrupt flags
-volatile bool buttonPressed = false;
-volatile bool encoderPressed = false;
-
-// ISR handlers
-void IRAM_ATTR buttonISR()
+// Button indices, in the order they are added to the gesture detector
+enum ButtonId
 {
-  buttonPressed = true;
-}
-
-void IRAM_ATTR encoderSwitchISR()
+  BUTTON_PREV,
+  BUTTON_PLAY,
+  BUTTON_NEXT,
+  BUTTON_ENC_SW
+};
+
+// Encoder volume steps (percent per count) and speeds (counts per second)
+#define VOLUME_STEP_SLOW 2
+#define VOLUME_STEP_MEDIUM 4
+#define VOLUME_STEP_FAST 8
+#define VOLUME_MEDIUM_RATE 10
+#define VOLUME_FAST_RATE 25
+
+// Scrub steps while the encoder switch is held (ms per count)
+#define SCRUB_STEP_SLOW 1000
+#define SCRUB_STEP_MEDIUM 3000
+#define SCRUB_STEP_FAST 10000
+
+// Display frame pacing
+#define FRAME_MS 40
+#define FRAME_REPORT_MS 10000
+
+// Screen currently on the display
+enum ScreenId
 {
-  encoderPressed = true;
-}
+  SCREEN_OTHER,
+  SCREEN_NO_DEVICE,
+  SCREEN_DEVICES,
+  SCREEN_BROWSE,
+  SCREEN_NOW_PLAYING
+};
+ScreenId currentScreen = SCREEN_OTHER;
 
 // Forward declarations
-String truncateString(const String &input, int maxLength);
-void handleButtons();
+void updateFrame();
+void handleInput();
 void handleVolumeControl();
 void drawScreen();
+void presentFrame();
+void traceFlush();
+void idleUntilNextEvent();
+bool handlePickerInput(const Gesture &gesture);
+bool handleBrowseInput(const Gesture &gesture);
+void setupRequestJobs();
+
+NowPlayingScreen nowPlaying(heart_filled, heart_outline);
+ListScreen devicePicker;
+ListScreen browseList;
+bool browsing = false;
+uint32_t tracedFrame = 0; // Handed-off frame the latency trace waits on, 0 if none
+
+const char *deviceLabel(int index)
+{
+  return spotifyConnection.devices[index].name.c_str();
+}
 
-// Bitmap Definitions
-static const unsigned char PROGMEM no_active_device[] = {0x07, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x07, 0xce, 0x78, 0x03, 0x80, 0x00, 0x41, 0x02, 0x00, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x04, 0x11, 0x44, 0x04, 0x40, 0x00, 0x40, 0x05, 0x00, 0x01, 0x00, 0x44, 0x01, 0xe0, 0x04, 0x10, 0x44, 0x04, 0x16, 0x39, 0xf3, 0x04, 0x44, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x07, 0x8e, 0x78, 0x03, 0x99, 0x44, 0x41, 0x0e, 0x44, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x04, 0x01, 0x40, 0x00, 0x59, 0x44, 0x41, 0x04, 0x3c, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x04, 0x11, 0x40, 0x04, 0x56, 0x44, 0x51, 0x04, 0x04, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x07, 0xce, 0x40, 0x03, 0x90, 0x38, 0x23, 0x84, 0x44, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x38, 0x01, 0x1f, 0xff, 0x9f, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x10, 0x00, 0x91, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xf0, 0x00, 0xf1, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x0f, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x00, 0x00, 0x08, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x00, 0x00, 0x08, 0x88, 0x62, 0x27, 0x2c, 0x00, 0x00, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x00, 0x00, 0x0f, 0x08, 0x12, 0x28, 0xb2, 0x00, 0x00, 0x01, 0x00, 0x44, 0x01, 0xe0, 0x00, 0x00, 0x08, 0x08, 0x71, 0xef, 0xa0, 0x00, 0x00, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x00, 0x00, 0x08, 0x08, 0x90, 0x28, 0x20, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x08, 0x1c, 0x7a, 0x27, 0x20, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x01, 0xc0, 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xfe, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xfc, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8, 0x00, 0x00, 0x00, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0, 0x00, 0x00, 0x00, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x20, 0x00, 0x20, 0x02, 0x08, 0x00, 0x00, 0x3c, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02, 0x20, 0x00, 0x50, 0x02, 0x00, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x27, 0x00, 0x89, 0xcf, 0x98, 0x89, 0xc0, 0x22, 0x72, 0x26, 0x1c, 0x70, 0x00, 0x02, 0xa8, 0x80, 0x8a, 0x22, 0x08, 0x8a, 0x20, 0x22, 0x8a, 0x22, 0x22, 0x88, 0x00, 0x02, 0x68, 0x80, 0xfa, 0x02, 0x08, 0x8b, 0xe0, 0x22, 0xfa, 0x22, 0x20, 0xf8, 0x00, 0x02, 0x28, 0x80, 0x8a, 0x22, 0x88, 0x52, 0x00, 0x22, 0x81, 0x42, 0x22, 0x80, 0x00, 0x02, 0x27, 0x00, 0x89, 0xc1, 0x1c, 0x21, 0xc0, 0x3c, 0x70, 0x87, 0x1c, 0x70, 0x00};
-static const unsigned char PROGMEM splash_screen[] = {0x07, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x07, 0xce, 0x78, 0x03, 0x80, 0x00, 0x41, 0x02, 0x00, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x04, 0x11, 0x44, 0x04, 0x40, 0x00, 0x40, 0x05, 0x00, 0x01, 0x00, 0x44, 0x01, 0xe0, 0x04, 0x10, 0x44, 0x04, 0x16, 0x39, 0xf3, 0x04, 0x44, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x07, 0x8e, 0x78, 0x03, 0x99, 0x44, 0x41, 0x0e, 0x44, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x04, 0x01, 0x40, 0x00, 0x59, 0x44, 0x41, 0x04, 0x3c, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x04, 0x11, 0x40, 0x04, 0x56, 0x44, 0x51, 0x04, 0x04, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x07, 0xce, 0x40, 0x03, 0x90, 0x38, 0x23, 0x84, 0x44, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x38, 0x01, 0x1f, 0xff, 0x9f, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x10, 0x00, 0x91, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xf0, 0x00, 0xf1, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x0f, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x00, 0x00, 0x08, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x00, 0x00, 0x08, 0x88, 0x62, 0x27, 0x2c, 0x00, 0x00, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x00, 0x00, 0x0f, 0x08, 0x12, 0x28, 0xb2, 0x00, 0x00, 0x01, 0x00, 0x44, 0x01, 0xe0, 0x00, 0x00, 0x08, 0x08, 0x71, 0xef, 0xa0, 0x00, 0x00, 0x01, 0x00, 0x7c, 0x01, 0xe0, 0x00, 0x00, 0x08, 0x08, 0x90, 0x28, 0x20, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x08, 0x1c, 0x7a, 0x27, 0x20, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x01, 0xc0, 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xff, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xfe, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0xff, 0xff, 0xfc, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8, 0x00, 0x00, 0x00, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0, 0x00, 0x00, 0x00, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x02, 0x20, 0x00, 0x00, 0x80, 0x20, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x80, 0x02, 0x40, 0x00, 0x00, 0x80, 0x20, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0xa2, 0x02, 0x86, 0x22, 0x7b, 0xe8, 0xac, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x22, 0x03, 0x01, 0x22, 0x80, 0x88, 0xb2, 0xc8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x9e, 0x02, 0x87, 0x22, 0x70, 0x88, 0xa2, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x82, 0x02, 0x49, 0x26, 0x08, 0xa9, 0xb2, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x22, 0x02, 0x27, 0x9a, 0xf0, 0x46, 0xac, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-static const unsigned char PROGMEM configuring[] = {0x80, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc1, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x22, 0x8c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0x0c, 0x07, 0x00, 0x00, 0x42, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x0a, 0xb4, 0x08, 0x80, 0x00, 0xa0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x48, 0x08, 0x1c, 0xb0, 0x86, 0x1c, 0x8a, 0xc6, 0x2c, 0x70, 0x00, 0x00, 0x05, 0xf0, 0x08, 0x22, 0xc9, 0xc2, 0x26, 0x8b, 0x22, 0x32, 0x98, 0x00, 0x00, 0x0b, 0x00, 0x08, 0x22, 0x88, 0x82, 0x26, 0x8a, 0x02, 0x22, 0x98, 0x00, 0x00, 0x14, 0xe0, 0x08, 0xa2, 0x88, 0x82, 0x1a, 0x9a, 0x02, 0x22, 0x68, 0xc3, 0x0c, 0x29, 0xb0, 0x07, 0x1c, 0x88, 0x87, 0x02, 0x6a, 0x07, 0x22, 0x08, 0xc3, 0x0c, 0x50, 0xd8, 0x00, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0xa0, 0x6c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x34, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+const char *browseLabel(int index)
+{
+  return playlistBrowser.label(index);
+}
 
 void drawScreen()
 {
-  display.clearDisplay();
-
-  if (!spotifyConnection.getActiveStatus())
+  if (browsing)
   {
-    // Show the no active device screen
-    display.drawBitmap(9, 8, no_active_device, 112, 49, 1);
-  }
-  else
-  {
-    // Display content for active device
-    display.setTextColor(SH110X_WHITE);
-    display.setTextSize(1);
-
-    // Truncate long strings
-    String songName = truncateString(spotifyConnection.getCurrentSong().song, 20);
-    String artistName = truncateString(spotifyConnection.getCurrentSong().artist, 20);
+    if (currentScreen != SCREEN_BROWSE)
+    {
+      display.clearDisplay();
+      browseList.invalidate();
+      currentScreen = SCREEN_BROWSE;
+    }
 
-    // Display song info
-    display.setCursor(0, 0);
-    display.print(songName);
+    // Only the visible rows ask the browser for labels
+    browseList.update(playlistBrowser.title(), playlistBrowser.count(), browseLabel);
+    latencyTracer.mark(TRACE_DRAW);
+    if (browseList.render(display))
+    {
+      presentFrame();
+    }
+    return;
+  }
 
-    display.setCursor(0, 15);
-    display.print(artistName);
+  if (!spotifyConnection.getActiveStatus() && spotifyConnection.deviceCount > 0)
+  {
+    // Nothing playing, offer the devices Spotify knows about
+    if (currentScreen != SCREEN_DEVICES)
+    {
+      display.clearDisplay();
+      devicePicker.invalidate();
+      currentScreen = SCREEN_DEVICES;
+    }
 
-    // Draw progress bar
-    int barY = 30;
-    int barHeight = 8;
-    int barWidth = map(spotifyConnection.getCurrentPositionMs(), 0, spotifyConnection.getCurrentSong().durationMs, 0, SCREEN_WIDTH);
+    devicePicker.update("Play on:", spotifyConnection.deviceCount, deviceLabel);
+    latencyTracer.mark(TRACE_DRAW);
+    if (devicePicker.render(display))
+    {
+      presentFrame();
+    }
+    return;
+  }
 
-    display.drawRect(0, barY, SCREEN_WIDTH, barHeight, SH110X_WHITE);
-    display.fillRect(0, barY, barWidth, barHeight, SH110X_WHITE);
+  if (!spotifyConnection.getActiveStatus())
+  {
+    // Show the no active device screen
+    if (currentScreen != SCREEN_NO_DEVICE)
+    {
+      latencyTracer.mark(TRACE_DRAW);
+      display.clearDisplay();
+      display.drawPackedBitmap(9, 8, no_active_device);
+      presentFrame();
+      currentScreen = SCREEN_NO_DEVICE;
+    }
+    return;
+  }
 
-    // Display play/pause state
-    display.setCursor(45, 55);
-    display.print(spotifyConnection.getStatus() ? "Playing" : "Paused");
+  // Coming from another screen, everything needs drawing
+  if (currentScreen != SCREEN_NOW_PLAYING)
+  {
+    display.clearDisplay();
+    nowPlaying.invalidate();
+    currentScreen = SCREEN_NOW_PLAYING;
+  }
 
-    // Display volume
-    display.setCursor(110, 55);
-    display.print(spotifyConnection.volCtrl ? String(spotifyConnection.currVol) : "N/A");
+  // Only widgets whose state changed redraw their region
+  nowPlaying.update(spotifyConnection, millis());
+  latencyTracer.mark(TRACE_DRAW);
+  if (nowPlaying.render(display))
+  {
+    presentFrame();
   }
-  display.display();
 }
 
-// Helper function to truncate strings
-String truncateString(const String &input, int maxLength)
+// Queue the frame for the flush task; the trace's flush stage is marked
+// by traceFlush() once the transfer has actually finished
+void presentFrame()
 {
-  if (input.length() <= maxLength)
-    return input;
-  return input.substring(0, maxLength - 3) + "...";
+  if (display.present())
+  {
+    latencyTracer.mark(TRACE_HANDOFF);
+    tracedFrame = display.presentedFrame();
+  }
 }
 
-// Button handler function
-void handleButtons()
+void traceFlush()
 {
-  // Only process if interrupt flag is set
-  if (!buttonPressed && !encoderPressed)
+  uint32_t doneUs;
+  if (tracedFrame != 0 && display.frameShown(tracedFrame, doneUs))
   {
-    return;
+    latencyTracer.markAt(TRACE_FLUSH, doneUs);
+    tracedFrame = 0;
   }
+}
 
-  // Add debounce delay
-  static unsigned long lastButtonTime = 0;
-  unsigned long currentTime = millis();
+// Paced redraw for animations, reports CPU time per frame
+void updateFrame()
+{
+  static unsigned long lastFrame = 0;
+  static unsigned long lastReport = 0;
+  static unsigned long frameCount = 0;
+  static unsigned long totalFrameUs = 0;
+  static unsigned long maxFrameUs = 0;
+
+  traceFlush();
 
-  if (currentTime - lastButtonTime < 150)
+  unsigned long now = millis();
+  if (currentScreen == SCREEN_OTHER || now - lastFrame < FRAME_MS)
   {
-    buttonPressed = false;
-    encoderPressed = false;
     return;
   }
+  lastFrame = now;
 
-  bool actionTaken = false;
+  unsigned long frameStart = micros();
+  drawScreen();
+  unsigned long frameUs = micros() - frameStart;
 
-  if (prevBtn.isPressed())
+  totalFrameUs += frameUs;
+  maxFrameUs = max(maxFrameUs, frameUs);
+  frameCount++;
+
+  if (now - lastReport > FRAME_REPORT_MS)
   {
-    Serial.println("Previous button pressed");
-    spotifyConnection.skipBack();
-    actionTaken = true;
+    FlushStats flush = display.takeFlushStats();
+    Serial.printf("Frames: %lu, avg %lu us, max %lu us; flushed %lu, avg %lu us, max %lu us, %lu dropped\n",
+                  frameCount, totalFrameUs / frameCount, maxFrameUs,
+                  flush.sent, flush.sent ? flush.totalUs / flush.sent : 0, flush.maxUs, flush.dropped);
+    lastReport = now;
+    frameCount = 0;
+    totalFrameUs = 0;
+    maxFrameUs = 0;
   }
-  else if (playBtn.isPressed())
+}
+
+// Input handler: dispatch debounced gestures from the ISR event ring
+void handleInput()
+{
+  Gesture gesture;
+  while (inputs.next(gesture))
   {
-    Serial.println("Play button pressed");
-    spotifyConnection.togglePlay();
-    actionTaken = true;
+    // Queueing delay of the command it may send counts from the press
+    requestScheduler.markDue(REQUEST_COMMAND, millis() - (micros() - gesture.timeUs) / 1000);
+
+    if (currentScreen == SCREEN_DEVICES && handlePickerInput(gesture))
+    {
+      continue;
+    }
+    if (handleBrowseInput(gesture))
+    {
+      continue;
+    }
+
+    switch (gesture.button)
+    {
+    case BUTTON_PREV:
+      latencyTracer.begin(TRACE_CMD_PREV, gesture.timeUs);
+      latencyTracer.mark(TRACE_DISPATCH);
+      Serial.println("Previous button pressed");
+      spotifyConnection.skipBack();
+      break;
+    case BUTTON_NEXT:
+      latencyTracer.begin(TRACE_CMD_NEXT, gesture.timeUs);
+      latencyTracer.mark(TRACE_DISPATCH);
+      Serial.println("Next button pressed");
+      spotifyConnection.skipForward();
+      break;
+    case BUTTON_PLAY:
+      latencyTracer.begin(TRACE_CMD_PLAY, gesture.timeUs);
+      latencyTracer.mark(TRACE_DISPATCH);
+      Serial.println("Play button pressed");
+      spotifyConnection.togglePlay();
+      break;
+    case BUTTON_ENC_SW:
+      if (gesture.type == GESTURE_LONG)
+      {
+        latencyTracer.begin(TRACE_CMD_LIKE, gesture.timeUs);
+        latencyTracer.mark(TRACE_DISPATCH);
+        Serial.println("Encoder switch long pressed");
+        spotifyConnection.toggleLiked();
+        continue;
+      }
+      latencyTracer.begin(TRACE_CMD_PLAY, gesture.timeUs);
+      latencyTracer.mark(TRACE_DISPATCH);
+      Serial.println("Encoder switch pressed");
+      spotifyConnection.togglePlay();
+      break;
+    }
+
+    spotifyConnection.requestTrackInfo();
   }
-  else if (nextBtn.isPressed())
+}
+
+// Device picker: prev/next move, play or encoder switch transfers playback
+bool handlePickerInput(const Gesture &gesture)
+{
+  switch (gesture.button)
   {
-    Serial.println("Next button pressed");
-    spotifyConnection.skipForward();
-    actionTaken = true;
+  case BUTTON_PREV:
+    devicePicker.move(-1);
+    break;
+  case BUTTON_NEXT:
+    devicePicker.move(1);
+    break;
+  case BUTTON_PLAY:
+  case BUTTON_ENC_SW:
+  {
+    int index = devicePicker.selected();
+    if (index >= spotifyConnection.deviceCount)
+    {
+      return true;
+    }
+    Serial.println("Transferring playback to " + String(spotifyConnection.devices[index].name.c_str()));
+    spotifyConnection.transferPlayback(spotifyConnection.devices[index].id.c_str());
+    break;
+  }
+  default:
+    return false;
   }
-  else if (encSwBtn.isPressed())
+
+  drawScreen();
+  return true;
+}
+
+// Playlist browser: hold previous to open or leave it, previous/next move,
+// the encoder switch opens a playlist or plays a track, play goes back
+bool handleBrowseInput(const Gesture &gesture)
+{
+  if (gesture.button == BUTTON_PREV && gesture.type == GESTURE_LONG)
   {
-    Serial.println("Encoder switch pressed");
-    spotifyConnection.togglePlay();
-    actionTaken = true;
+    browsing = !browsing;
+    if (browsing)
+    {
+      Serial.println("Opening playlist browser");
+      playlistBrowser.openPlaylists();
+      browseList.select(0);
+    }
+    drawScreen();
+    return true;
   }
 
-  if (actionTaken)
+  if (!browsing)
   {
-    spotifyConnection.getTrackInfo();
-    lastButtonTime = currentTime;
+    return false;
   }
 
-  // Reset flags
-  buttonPressed = false;
-  encoderPressed = false;
+  switch (gesture.button)
+  {
+  case BUTTON_PREV:
+    browseList.move(-1);
+    break;
+  case BUTTON_NEXT:
+    browseList.move(1);
+    break;
+  case BUTTON_PLAY:
+    if (playlistBrowser.atTracks())
+    {
+      browseList.select(playlistBrowser.closePlaylist());
+    }
+    else
+    {
+      browsing = false;
+    }
+    break;
+  case BUTTON_ENC_SW:
+    if (!playlistBrowser.atTracks())
+    {
+      if (playlistBrowser.openPlaylist(browseList.selected()))
+      {
+        browseList.select(0);
+      }
+    }
+    else if (playlistBrowser.playTrack(browseList.selected()))
+    {
+      browsing = false;
+    }
+    break;
+  }
 
-  prevBtn.loop();
-  playBtn.loop();
-  nextBtn.loop();
-  encSwBtn.loop();
+  drawScreen();
+  return true;
 }
 
 // Volume control handler
 void handleVolumeControl()
 {
-  if (!spotifyConnection.volCtrl)
+  static int lastEncoderCount = 0;
+  static unsigned long lastMoveTime = 0;
+
+  // Letting go of the switch ends a scrub
+  if (spotifyConnection.scrubbing && !inputs.held(BUTTON_ENC_SW))
+  {
+    spotifyConnection.endScrub();
+  }
+
+  int currentCount = encoder.getCount();
+  int delta = currentCount - lastEncoderCount;
+  if (delta == 0)
   {
     return;
   }
+  lastEncoderCount = currentCount;
 
-  static int lastEncoderCount = 0;
-  static unsigned long lastVolumeChange = 0;
-  static bool volumeChangePending = false;
+  // The encoder scrolls the device list or the browser while they are shown
+  if (currentScreen == SCREEN_DEVICES)
+  {
+    devicePicker.move(delta);
+    drawScreen();
+    return;
+  }
+  if (currentScreen == SCREEN_BROWSE)
+  {
+    browseList.move(delta);
+    drawScreen();
+    return;
+  }
 
-  int currentCount = encoder.getCount();
+  // Scale the step with how fast the knob is turning
+  unsigned long now = millis();
+  unsigned long elapsed = max(now - lastMoveTime, 1UL);
+  unsigned long countsPerSecond = abs(delta) * 1000UL / elapsed;
+  lastMoveTime = now;
 
-  // Detect encoder movement
-  if (currentCount != lastEncoderCount)
+  // Hold the switch and turn to scrub; purely local until serviceSeek()
+  if (inputs.held(BUTTON_ENC_SW) && currentScreen == SCREEN_NOW_PLAYING)
   {
-    lastEncoderCount = currentCount;
-    lastVolumeChange = millis();
-    volumeChangePending = true;
+    inputs.consume(BUTTON_ENC_SW);
 
-    // Update display immediately with new volume (optimistic update)
-    int newVolume = constrain(currentCount * 5, 0, 100);
-    spotifyConnection.currVol = newVolume;
-    drawScreen(); // Show new volume immediately
+    long step = SCRUB_STEP_SLOW;
+    if (countsPerSecond > VOLUME_FAST_RATE)
+      step = SCRUB_STEP_FAST;
+    else if (countsPerSecond > VOLUME_MEDIUM_RATE)
+      step = SCRUB_STEP_MEDIUM;
+
+    spotifyConnection.scrubBy(delta * step);
+    drawScreen();
+    return;
+  }
+
+  // Turning without volume support just moves the baseline
+  if (!spotifyConnection.volCtrl)
+  {
+    return;
   }
 
-  // Send API request after encoder stops moving for 500ms
-  if (volumeChangePending && (millis() - lastVolumeChange > 500))
+  // Trace the first detent of a turn (the encoder has no edge ISR)
+  if (elapsed > 500)
   {
-    int newVolume = currentCount * 5;
-    spotifyConnection.adjustVolume(newVolume);
-    volumeChangePending = false;
+    latencyTracer.begin(TRACE_CMD_VOLUME, micros());
+    latencyTracer.mark(TRACE_DISPATCH);
   }
+
+  int step = VOLUME_STEP_SLOW;
+  if (countsPerSecond > VOLUME_FAST_RATE)
+    step = VOLUME_STEP_FAST;
+  else if (countsPerSecond > VOLUME_MEDIUM_RATE)
+    step = VOLUME_STEP_MEDIUM;
+
+  // Optimistic update, the request is streamed from loop()
+  spotifyConnection.setVolumeTarget(spotifyConnection.currVol + delta * step);
+  drawScreen();
 }
 
 // Global flag for server state
@@ -225,29 +476,46 @@ void setup()
   // Initialize display
   delay(250); // Wait for OLED to initialize
   display.begin(I2C_ADDRESS, true);
+  display.startFlushTask();
 
   // Show splash screen
   display.clearDisplay();
-  display.drawBitmap(9, 8, splash_screen, 112, 51, 1);
-  display.display();
+  unsigned long decodeStart = micros();
+  display.drawPackedBitmap(9, 8, splash_screen);
+  Serial.printf("Splash decoded in %lu us\n", micros() - decodeStart);
+  display.present();
   delay(700);
 
-  // Set up button pins
-  pinMode(PLAY_BTN_PIN, INPUT_PULLUP);
-  pinMode(PREV_BTN_PIN, INPUT_PULLUP);
-  pinMode(NEXT_BTN_PIN, INPUT_PULLUP);
-  pinMode(ENC_SW_PIN, INPUT_PULLUP);
-  attachInterrupt(digitalPinToInterrupt(PLAY_BTN_PIN), buttonISR, FALLING);
-  attachInterrupt(digitalPinToInterrupt(PREV_BTN_PIN), buttonISR, FALLING);
-  attachInterrupt(digitalPinToInterrupt(NEXT_BTN_PIN), buttonISR, FALLING);
-  attachInterrupt(digitalPinToInterrupt(ENC_SW_PIN), encoderSwitchISR, FALLING);
+  // Set up buttons (pin, long press, double press)
+  inputs.addButton(PREV_BTN_PIN, true, false);
+  inputs.addButton(PLAY_BTN_PIN, false, false);
+  inputs.addButton(NEXT_BTN_PIN, false, false);
+  inputs.addButton(ENC_SW_PIN, true, false);
+  inputs.begin();
 
   // Set up rotary encoder
   encoder.attachHalfQuad(ENC_DT_PIN, ENC_CLK_PIN);
 
+  // Sleep between events, waking on any button or encoder edge
+  idleManager.begin();
+  idleManager.addWakePin(PREV_BTN_PIN, false);
+  idleManager.addWakePin(PLAY_BTN_PIN, false);
+  idleManager.addWakePin(NEXT_BTN_PIN, false);
+  idleManager.addWakePin(ENC_SW_PIN, false);
+  idleManager.addWakePin(ENC_CLK_PIN, true);
+  idleManager.addWakePin(ENC_DT_PIN, true);
+
   setDrawScreenCallback(drawScreen);
+  setupRequestJobs();
   spotifyConnection.initialize();
-  encoder.setCount(spotifyConnection.getCurrentVolume() / 5);
+  if (LAN_API)
+  {
+    lanApi.begin(secureServer);
+  }
+  if (MULTICAST_SYNC)
+  {
+    multicastSync.begin();
+  }
 
   // Show configuration screen
   display.clearDisplay();
@@ -255,14 +523,12 @@ void setup()
   display.setTextWrap(false);
   display.setCursor(5, 38);
   display.print("ESP IP:" + WiFi.localIP().toString());
-  display.drawBitmap(14, 15, configuring, 102, 15, 1);
-  display.display();
+  display.drawPackedBitmap(14, 16, configuring);
+  display.present();
 }
 
 void loop()
 {
-  unsigned long currentMillis = millis();
-
   // If not authenticated, handle web server requests
   if (!spotifyConnection.accessTokenSet)
   {
@@ -270,56 +536,263 @@ void loop()
     return;
   }
 
-  // Close server after authentication
-  if (serverOn)
+  // Close server after authentication, unless it serves the LAN API
+  if (LAN_API)
+  {
+    secureServer->loop();
+  }
+  else if (serverOn)
   {
     secureServer->stop();
     serverOn = false;
   }
 
-  // Refresh access token if needed
-  if ((currentMillis - spotifyConnection.tokenStartTime) / 1000 > spotifyConnection.tokenExpireTime - 60)
+  // Handle user inputs
+  handleInput();
+  handleVolumeControl();
+  updateFrame();
+
+  // Followers get the playback state from the leading controller
+  multicastSync.service();
+  if (multicastSync.following())
   {
-    Serial.println("Refreshing token");
-    if (spotifyConnection.refreshAuth())
-    {
-      Serial.println("Token refreshed successfully");
-    }
+    spotifyConnection.trackInfoPending = false;
   }
 
-  // Handle user inputs
-  handleButtons();
-  handleVolumeControl();
+  // One job per pass, most urgent first, so input that arrives meanwhile
+  // is handled before the next background request (see setupRequestJobs)
+  bool requested = requestScheduler.run();
+  lanApi.publish();
+
+  latencyTracer.report();
+  idleManager.report();
+  lanApi.report();
+  multicastSync.report();
+  requestScheduler.report();
+  dnsCache.report();
+  soakMonitor.report();
+  spotifyConnection.playbackClock.report();
+
+  // More jobs may be due, only sleep once the scheduler found nothing to do
+  if (!requested)
+  {
+    idleUntilNextEvent();
+  }
+}
 
-  // Update track info periodically
-  unsigned long pollInterval = spotifyConnection.isPlaying ? API_REFRESH_INTERVAL : 30000; // 30s when paused
-  if (currentMillis - lastApiRefresh > pollInterval)
+// -------- REQUEST JOBS --------
+// User commands: queued presses, streamed volume and seeks, the offline journal
+bool commandsDue()
+{
+  return spotifyConnection.commandsDue();
+}
+
+void runCommands()
+{
+  spotifyConnection.serviceCommands();
+}
+
+// Refresh access token if needed (or rejected), spaced out while it fails
+bool tokenDue()
+{
+  return spotifyConnection.refreshDue();
+}
+
+void runTokenRefresh()
+{
+  Serial.println("Refreshing token");
+  if (spotifyConnection.refreshAuth())
   {
-    spotifyConnection.getTrackInfo();
-    lastApiRefresh = currentMillis;
+    Serial.println("Token refreshed successfully");
   }
 }
 
-// Web server handlers
-void handleRoot(HTTPRequest *req, HTTPResponse *res)
+// Update track info periodically, sharing the refresh any command already asked for
+bool pollDue()
 {
-  Serial.println("Handling root request");
+  if (multicastSync.following())
+  {
+    return false;
+  }
+  return spotifyConnection.trackInfoPending ||
+         millis() - spotifyConnection.lastTrackInfoTime > spotifyConnection.trackInfoInterval();
+}
+
+void runPoll()
+{
+  spotifyConnection.getTrackInfo();
+}
+
+// Load the pages the browser asked for, and the next one before it is needed
+bool browserDue()
+{
+  return browsing && playlistBrowser.due(browseList.selected());
+}
+
+void runBrowser()
+{
+  if (playlistBrowser.service(browseList.selected()))
+  {
+    drawScreen();
+  }
+}
+
+// Liked state of a track the cache did not know yet, looked up after the poll
+bool likedDue()
+{
+  return spotifyConnection.likedDue();
+}
+
+void runLiked()
+{
+  if (spotifyConnection.serviceLiked())
+  {
+    drawScreen();
+  }
+}
+
+// Keep the device list fresh in the background while nothing is playing
+bool devicesDue()
+{
+  return !spotifyConnection.getActiveStatus() && spotifyConnection.devicesStale();
+}
+
+void runDevices()
+{
+  if (spotifyConnection.fetchDevices())
+  {
+    drawScreen();
+  }
+}
+
+// Look the Spotify hosts up again before their cached address expires
+bool dnsDue()
+{
+  return WiFi.isConnected() && dnsCache.refreshDue();
+}
+
+void runDnsRefresh()
+{
+  dnsCache.refresh();
+}
 
-  // Static buffer (safer than stack allocation)
-  static char page[8192];
+// A button edge waiting in the ring preempts polls and background requests
+bool userInputWaiting()
+{
+  return !inputRing.empty();
+}
 
-  // Generate the page
-  if (snprintf(page, sizeof(page), mainPage, CLIENT_ID, REDIRECT_URI) < 0)
+void setupRequestJobs()
+{
+  requestScheduler.addJob(REQUEST_COMMAND, commandsDue, runCommands);
+  requestScheduler.addJob(REQUEST_TOKEN, tokenDue, runTokenRefresh);
+  requestScheduler.addJob(REQUEST_POLL, pollDue, runPoll);
+  requestScheduler.addJob(REQUEST_BACKGROUND, likedDue, runLiked);
+  requestScheduler.addJob(REQUEST_BACKGROUND, browserDue, runBrowser);
+  requestScheduler.addJob(REQUEST_BACKGROUND, devicesDue, runDevices);
+  requestScheduler.addJob(REQUEST_BACKGROUND, dnsDue, runDnsRefresh);
+  requestScheduler.setPreemptCheck(userInputWaiting);
+}
+
+// Sleep until the next timer (poll, token refresh, frame) or an input edge
+void idleUntilNextEvent()
+{
+  unsigned long now = millis();
+
+  // Work that is due right away or needs fine-grained timing
+  if (spotifyConnection.trackInfoPending || inputs.busy())
   {
-    res->setStatusCode(500);
-    res->setStatusText("Internal Server Error");
-    res->println("Failed to generate page");
     return;
   }
 
-  // Set headers and send response
+  unsigned long pollInterval = spotifyConnection.trackInfoInterval();
+  unsigned long wait = spotifyConnection.lastTrackInfoTime + pollInterval + 1 - now;
+  if (now - spotifyConnection.lastTrackInfoTime > pollInterval)
+  {
+    wait = 0;
+  }
+
+  unsigned long tokenRefreshAt = spotifyConnection.tokenStartTime + (spotifyConnection.tokenExpireTime - 60) * 1000UL;
+  if ((long)(tokenRefreshAt - now) <= 0 || httpsSession.authRejected)
+  {
+    // Overdue after a failed refresh, the next try is spaced out
+    tokenRefreshAt = spotifyConnection.lastRefreshAttempt + SpotConn::TOKEN_RETRY_INTERVAL + 1;
+  }
+  wait = min(wait, (long)(tokenRefreshAt - now) > 0 ? tokenRefreshAt - now : 0UL);
+
+  if (!spotifyConnection.getActiveStatus())
+  {
+    unsigned long devicesAge = now - spotifyConnection.devicesFetchedAt;
+    wait = min(wait, devicesAge < SpotConn::DEVICE_LIST_TTL ? SpotConn::DEVICE_LIST_TTL + 1 - devicesAge : 0UL);
+  }
+
+  if (browsing && playlistBrowser.pending())
+  {
+    wait = min(wait, (unsigned long)PlaylistBrowser::RETRY_INTERVAL);
+  }
+
+  if (spotifyConnection.volumePending)
+  {
+    wait = min(wait, (unsigned long)SpotConn::VOLUME_SEND_INTERVAL);
+  }
+
+  if (spotifyConnection.seekPending)
+  {
+    wait = min(wait, (unsigned long)SpotConn::SEEK_SEND_INTERVAL);
+  }
+
+  // Offline commands are retried
+  if (spotifyConnection.journalCount > 0)
+  {
+    wait = min(wait, (unsigned long)SpotConn::JOURNAL_RETRY_INTERVAL);
+  }
+
+  // The server is polled, LAN clients wait at most one interval
+  if (LAN_API)
+  {
+    wait = min(wait, (unsigned long)LanApi::POLL_INTERVAL);
+  }
+
+  // Sync packets are polled as well
+  if (MULTICAST_SYNC)
+  {
+    wait = min(wait, (unsigned long)MulticastSync::SERVICE_INTERVAL);
+  }
+
+  // The progress bar moves one pixel every duration / width while playing
+  int durationMs = spotifyConnection.currentSong.durationMs;
+  if (currentScreen == SCREEN_NOW_PLAYING && spotifyConnection.isPlaying && durationMs > 0)
+  {
+    wait = min(wait, (unsigned long)durationMs / SCREEN_WIDTH + 1);
+  }
+
+  bool animating = currentScreen == SCREEN_NOW_PLAYING && nowPlaying.animating();
+  if (animating)
+  {
+    wait = min(wait, (unsigned long)FRAME_MS);
+  }
+
+  // Light sleep only while nothing plays: progress and scrolling need the CPU
+  bool paused = !spotifyConnection.isPlaying;
+  idleManager.setPowerSave(paused);
+  idleManager.idleFor(wait, paused && !animating && !spotifyConnection.volumePending && !LAN_API && !MULTICAST_SYNC && !display.flushBusy());
+}
+
+// Web server handlers
+
+// Pages are prebuilt and gzipped (tools/build_pages.py), sent straight from flash
+void sendPage(HTTPResponse *res, const uint8_t *page, size_t length)
+{
   res->setHeader("Content-Type", "text/html");
-  res->println(page);
+  res->setHeader("Content-Encoding", "gzip");
+  res->setHeader("Content-Length", std::to_string(length));
+  res->write((uint8_t *)page, length);
+}
+
+void handleRoot(HTTPRequest *req, HTTPResponse *res)
+{
+  Serial.println("Handling root request");
+  sendPage(res, mainPage, mainPageLength);
 }
 
 void handleCallbackPage(HTTPRequest *req, HTTPResponse *res)
@@ -337,16 +810,7 @@ void handleCallbackPage(HTTPRequest *req, HTTPResponse *res)
   {
     if (code.empty())
     {
-      static char page[8192];
-      if (snprintf(page, sizeof(page), errorPage, CLIENT_ID, REDIRECT_URI) < 0)
-      {
-        res->setStatusCode(500);
-        res->setStatusText("Internal Server Error");
-        res->println("Error page generation failed");
-        return;
-      }
-      res->setHeader("Content-Type", "text/html");
-      res->println(page);
+      sendPage(res, errorPage, errorPageLength);
     }
     else
     {
@@ -359,16 +823,7 @@ void handleCallbackPage(HTTPRequest *req, HTTPResponse *res)
       }
       else
       {
-        static char page[800];
-        if (snprintf(page, sizeof(page), errorPage, CLIENT_ID, REDIRECT_URI) < 0)
-        {
-          res->setStatusCode(500);
-          res->setStatusText("Internal Server Error");
-          res->println("Error page generation failed");
-          return;
-        }
-        res->setHeader("Content-Type", "text/html");
-        res->println(page);
+        sendPage(res, errorPage, errorPageLength);
       }
     }
   }
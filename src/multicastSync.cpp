@@ -0,0 +1,171 @@
+#include "multicastSync.h"
+#include "requestScheduler.h"
+
+MulticastSync multicastSync;
+
+// -------- STATE --------
+size_t MulticastSync::encodeState(uint8_t *buffer, size_t size, SpotConn &conn)
+{
+    const SongDetails &song = conn.getCurrentSong();
+    SyncState state;
+
+    state.flags = 0;
+    if (conn.getActiveStatus())
+        state.flags |= SYNC_FLAG_ACTIVE;
+    if (conn.getStatus())
+        state.flags |= SYNC_FLAG_PLAYING;
+    if (conn.volCtrl)
+        state.flags |= SYNC_FLAG_VOLUME;
+    if (song.isLiked)
+        state.flags |= SYNC_FLAG_LIKED;
+
+    state.volume = conn.getCurrentVolume();
+    state.positionMs = conn.getCurrentPositionMs();
+    state.durationMs = song.durationMs;
+    state.id = song.Id;
+    state.song = song.song;
+    state.artist = song.artist;
+    state.album = song.album;
+
+    return encodeSyncState(buffer, size, state);
+}
+
+bool MulticastSync::decodeState(const uint8_t *buffer, size_t length, SpotConn &conn)
+{
+    SyncState state;
+    if (!decodeSyncState(buffer, length, state))
+    {
+        return false;
+    }
+
+    SongDetails song;
+    song.durationMs = state.durationMs;
+    song.Id = state.id;
+    song.song = state.song;
+    song.artist = state.artist;
+    song.album = state.album;
+    song.isLiked = state.flags & SYNC_FLAG_LIKED;
+
+    // The leader sends its clock estimate, LAN delay is negligible
+    bool playing = state.flags & SYNC_FLAG_PLAYING;
+    conn.applySharedState(state.flags & SYNC_FLAG_ACTIVE, playing, state.flags & SYNC_FLAG_VOLUME, state.volume, state.positionMs, song);
+    return true;
+}
+
+// -------- NETWORK --------
+MulticastSync::MulticastSync() : group(239, 255, 42, 99),
+                                 enabled(false),
+                                 node(*this, *this),
+                                 lastReport(0)
+{
+}
+
+void MulticastSync::begin()
+{
+    // getEfuseMac() keeps MAC[0] in the low byte, so the low 32 bits are
+    // mostly the shared Espressif OUI. The top four bytes hold the three
+    // NIC-specific ones, unique per board.
+    uint32_t nodeId = (uint32_t)(ESP.getEfuseMac() >> 16);
+
+    // Command IDs from before a restart must not look like resends
+    node.begin(nodeId, esp_random());
+
+    if (!udp.beginMulticast(group, PORT))
+    {
+        Serial.println("Multicast sync: failed to join group");
+        return;
+    }
+
+    enabled = true;
+    lastReport = millis();
+    Serial.printf("Multicast sync: node %08x on %s:%u\n", nodeId, group.toString().c_str(), PORT);
+}
+
+void MulticastSync::service()
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    node.service();
+}
+
+bool MulticastSync::forwardCommand(CommandType type, int value)
+{
+    return enabled && node.forwardCommand(type, value);
+}
+
+size_t MulticastSync::receive(uint8_t *buffer, size_t size)
+{
+    // Skips datagrams too short to read, parsePacket() moves on to the next
+    while (udp.parsePacket() > 0)
+    {
+        int length = udp.read(buffer, size);
+        if (length > 0)
+        {
+            return length;
+        }
+    }
+    return 0;
+}
+
+void MulticastSync::send(const uint8_t *header, size_t headerLength, const uint8_t *body, size_t bodyLength)
+{
+    udp.beginMulticastPacket();
+    udp.write(header, headerLength);
+    if (bodyLength > 0)
+    {
+        udp.write(body, bodyLength);
+    }
+    udp.endPacket();
+}
+
+// -------- PLAYER --------
+size_t MulticastSync::encodeState(uint8_t *buffer, size_t size)
+{
+    return encodeState(buffer, size, spotifyConnection);
+}
+
+bool MulticastSync::applyState(const uint8_t *buffer, size_t length)
+{
+    return decodeState(buffer, length, spotifyConnection);
+}
+
+void MulticastSync::runCommand(uint8_t type, int32_t value)
+{
+    spotifyConnection.sendCommand((CommandType)type, value);
+}
+
+void MulticastSync::journalCommand(uint8_t type, int32_t value, unsigned long queuedAt)
+{
+    QueuedCommand queued = {(CommandType)type, value, queuedAt};
+    spotifyConnection.journalCommand(queued);
+    requestScheduler.markDue(REQUEST_COMMAND, queuedAt);
+}
+
+void MulticastSync::requestTrackInfo()
+{
+    spotifyConnection.requestTrackInfo();
+}
+
+unsigned long MulticastSync::lastPollTime()
+{
+    return spotifyConnection.lastTrackInfoTime;
+}
+
+void MulticastSync::report()
+{
+    if (!enabled)
+        return;
+
+    unsigned long now = millis();
+    if (now - lastReport < REPORT_INTERVAL)
+        return;
+
+    SyncStats sync = node.takeSyncStats();
+    Serial.printf("Multicast sync: %s %08x, %d peers, %lu packets in, %lu out, %lu command resends, %lu sent directly\n",
+                  following() ? "following" : "leading", node.leader(), node.knownPeers(),
+                  sync.packetsIn, sync.packetsOut, sync.commandRetries, sync.commandFallbacks);
+    lastReport = now;
+}
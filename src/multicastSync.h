@@ -0,0 +1,65 @@
+#ifndef MULTICASTSYNC_H
+#define MULTICASTSYNC_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include "spotifyClient.h"
+#include "syncNode.h"
+
+// Share one Spotify poll between several controllers on the same account
+#ifndef MULTICAST_SYNC
+#define MULTICAST_SYNC false
+#endif
+
+// Runs a SyncNode (syncNode.h) on UDP multicast, with SpotConn as the
+// shared player. Multicast has no link-layer retries; the node's acks and
+// resends make up for it.
+class MulticastSync : private SyncLink, private SyncPlayer
+{
+public:
+    static const uint16_t PORT = 4210;
+    static const unsigned long SERVICE_INTERVAL = 100; // Max idle time, packets are polled
+    static const unsigned long REPORT_INTERVAL = 30000;
+
+    MulticastSync();
+
+    void begin();
+
+    // Read packets, send heartbeats/state and re-run the election
+    void service();
+
+    // True when another controller polls Spotify for us
+    bool following() const { return enabled && node.following(); }
+
+    // Follower: hand a player command to the leader
+    bool forwardCommand(CommandType type, int value);
+
+    void report();
+
+    // Playback state to and from the packet codec in syncPacket.h
+    static size_t encodeState(uint8_t *buffer, size_t size, SpotConn &conn);
+    static bool decodeState(const uint8_t *buffer, size_t length, SpotConn &conn);
+
+private:
+    // SyncLink
+    size_t receive(uint8_t *buffer, size_t size) override;
+    void send(const uint8_t *header, size_t headerLength, const uint8_t *body, size_t bodyLength) override;
+
+    // SyncPlayer
+    size_t encodeState(uint8_t *buffer, size_t size) override;
+    bool applyState(const uint8_t *buffer, size_t length) override;
+    void runCommand(uint8_t type, int32_t value) override;
+    void journalCommand(uint8_t type, int32_t value, unsigned long queuedAt) override;
+    void requestTrackInfo() override;
+    unsigned long lastPollTime() override;
+
+    WiFiUDP udp;
+    IPAddress group;
+    bool enabled;
+    SyncNode node;
+    unsigned long lastReport;
+};
+
+extern MulticastSync multicastSync;
+
+#endif
@@ -0,0 +1,294 @@
+#include "oledDisplay.h"
+
+OledDisplay::OledDisplay(uint16_t w, uint16_t h, TwoWire *twi, int8_t rstPin, uint32_t i2cClock)
+    : Adafruit_SH1106G(w, h, twi, rstPin, i2cClock, i2cClock),
+      i2cClock(i2cClock),
+      pendingFrame(nullptr),
+      sendingFrame(nullptr),
+      pendingX1(0),
+      pendingY1(0),
+      pendingX2(-1),
+      pendingY2(-1),
+      presentedSeq(0),
+      pendingSeq(0),
+      shownSeq(0),
+      shownUs(0),
+      framePending(false),
+      sending(false),
+      flushTask(nullptr),
+      stats()
+{
+    portMUX_INITIALIZE(&frameLock);
+}
+
+// -------- FLUSH TASK --------
+bool OledDisplay::startFlushTask()
+{
+    size_t size = WIDTH * ((HEIGHT + 7) / 8);
+    pendingFrame = (uint8_t *)malloc(size);
+    sendingFrame = (uint8_t *)malloc(size);
+    if (!pendingFrame || !sendingFrame)
+    {
+        free(pendingFrame);
+        free(sendingFrame);
+        pendingFrame = sendingFrame = nullptr;
+        Serial.println("Display flush task: no memory, flushing inline");
+        return false;
+    }
+
+    if (i2c_dev)
+    {
+        i2c_dev->setSpeed(i2cClock);
+    }
+
+    // Core 0 next to WiFi, priority 1 so it only uses time nothing else wants
+    if (xTaskCreatePinnedToCore(flushTaskMain, "oledFlush", FLUSH_TASK_STACK, this, 1, &flushTask, 0) != pdPASS)
+    {
+        flushTask = nullptr;
+        Serial.println("Display flush task: failed to start, flushing inline");
+        return false;
+    }
+
+    Serial.printf("Display flush task started, I2C at %u Hz\n", i2cClock);
+    return true;
+}
+
+bool OledDisplay::present()
+{
+    if (window_x2 < window_x1 || window_y2 < window_y1)
+    {
+        return false;
+    }
+
+    presentedSeq++;
+    if (flushTask == nullptr)
+    {
+        display(); // Blocking fallback, resets the window itself
+        shownSeq = presentedSeq;
+        shownUs = micros();
+        return true;
+    }
+
+    // The copy is a 1 KB memcpy, far shorter than any I2C transfer
+    portENTER_CRITICAL(&frameLock);
+    if (framePending)
+    {
+        // The flush task has not picked up the previous frame, send the union
+        stats.dropped++;
+        pendingX1 = min(pendingX1, window_x1);
+        pendingY1 = min(pendingY1, window_y1);
+        pendingX2 = max(pendingX2, window_x2);
+        pendingY2 = max(pendingY2, window_y2);
+    }
+    else
+    {
+        pendingX1 = window_x1;
+        pendingY1 = window_y1;
+        pendingX2 = window_x2;
+        pendingY2 = window_y2;
+    }
+    memcpy(pendingFrame, buffer, WIDTH * ((HEIGHT + 7) / 8));
+    pendingSeq = presentedSeq;
+    framePending = true;
+    portEXIT_CRITICAL(&frameLock);
+
+    window_x1 = 1024;
+    window_y1 = 1024;
+    window_x2 = -1;
+    window_y2 = -1;
+
+    xTaskNotifyGive(flushTask);
+    return true;
+}
+
+bool OledDisplay::frameShown(uint32_t frame, uint32_t &doneUs)
+{
+    portENTER_CRITICAL(&frameLock);
+    bool shown = (int32_t)(shownSeq - frame) >= 0;
+    doneUs = shownUs;
+    portEXIT_CRITICAL(&frameLock);
+    return shown;
+}
+
+FlushStats OledDisplay::takeFlushStats()
+{
+    portENTER_CRITICAL(&frameLock);
+    FlushStats taken = stats;
+    stats = FlushStats();
+    portEXIT_CRITICAL(&frameLock);
+    return taken;
+}
+
+void OledDisplay::flushTaskMain(void *arg)
+{
+    static_cast<OledDisplay *>(arg)->flushLoop();
+}
+
+void OledDisplay::flushLoop()
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // Frames presented meanwhile replace the pending one, only the latest is sent
+        while (framePending)
+        {
+            portENTER_CRITICAL(&frameLock);
+            memcpy(sendingFrame, pendingFrame, WIDTH * ((HEIGHT + 7) / 8));
+            int16_t x1 = pendingX1, y1 = pendingY1, x2 = pendingX2, y2 = pendingY2;
+            uint32_t seq = pendingSeq;
+            framePending = false;
+            sending = true;
+            portEXIT_CRITICAL(&frameLock);
+
+            unsigned long start = micros();
+            sendFrame(sendingFrame, x1, y1, x2, y2);
+            unsigned long done = micros();
+            unsigned long flushUs = done - start;
+
+            portENTER_CRITICAL(&frameLock);
+            sending = false;
+            shownSeq = seq;
+            shownUs = done;
+            stats.sent++;
+            stats.totalUs += flushUs;
+            stats.maxUs = max(stats.maxUs, flushUs);
+            portEXIT_CRITICAL(&frameLock);
+        }
+    }
+}
+
+// Same transfer as Adafruit_SH1106G::display(), but from our own copy and
+// limited to the dirty pages
+void OledDisplay::sendFrame(const uint8_t *frame, int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    if (!i2c_dev)
+    {
+        return;
+    }
+
+    x1 = max<int16_t>(x1, 0);
+    x2 = min<int16_t>(x2, WIDTH - 1);
+    int16_t firstPage = max<int16_t>(y1, 0) / 8;
+    int16_t lastPage = min<int16_t>(y2, HEIGHT - 1) / 8;
+    size_t maxChunk = i2c_dev->maxBufferSize() - 1;
+    uint8_t dataPrefix = 0x40;
+
+    for (int16_t page = firstPage; page <= lastPage; page++)
+    {
+        uint8_t column = x1 + _page_start_offset;
+        uint8_t cmd[] = {0x00, (uint8_t)(SH110X_SETPAGEADDR + page), (uint8_t)(0x10 + (column >> 4)), (uint8_t)(column & 0x0F)};
+        i2c_dev->write(cmd, sizeof(cmd));
+
+        const uint8_t *data = frame + page * WIDTH + x1;
+        size_t remaining = x2 - x1 + 1;
+        while (remaining > 0)
+        {
+            size_t count = min(remaining, maxChunk);
+            i2c_dev->write(data, count, true, &dataPrefix, 1);
+            data += count;
+            remaining -= count;
+        }
+    }
+}
+
+// -------- DRAWING --------
+void OledDisplay::markDirty(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    window_x1 = min(window_x1, x1);
+    window_y1 = min(window_y1, y1);
+    window_x2 = max(window_x2, x2);
+    window_y2 = max(window_y2, y2);
+}
+
+void OledDisplay::drawPackedBitmap(int16_t x, int16_t y, const PackedBitmap &bitmap)
+{
+    blitPackedBitmap(buffer, WIDTH, HEIGHT, x, y, bitmap);
+
+    int16_t pages = (bitmap.height + 7) / 8;
+    int16_t shift = y & 7;
+    markDirty(max<int16_t>(x, 0), max<int16_t>(y, 0),
+              min<int16_t>(x + bitmap.width - 1, WIDTH - 1), min<int16_t>(y + pages * 8 + shift - 1, HEIGHT - 1));
+}
+
+TextStrip::TextStrip() : Adafruit_GFX(MAX_WIDTH, 8),
+                         renderedWidth(0)
+{
+    memset(columns, 0, sizeof(columns));
+}
+
+void TextStrip::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    if (x < 0 || x >= MAX_WIDTH || y < 0 || y >= 8)
+        return;
+
+    if (color)
+        columns[x] |= (1 << y);
+    else
+        columns[x] &= ~(1 << y);
+}
+
+int16_t TextStrip::setText(const char *text)
+{
+    memset(columns, 0, sizeof(columns));
+
+    setTextColor(1);
+    setTextSize(1);
+    setTextWrap(false);
+    setCursor(0, 0);
+    print(text);
+
+    renderedWidth = min<int16_t>(getCursorX(), MAX_WIDTH);
+    return renderedWidth;
+}
+
+void TextStrip::blit(OledDisplay &target, int16_t x, uint8_t page, int16_t w, int16_t offset, int16_t period) const
+{
+    uint8_t *dst = target.getBuffer() + x + page * target.width();
+
+    for (int16_t i = 0; i < w; i++)
+    {
+        int16_t c = (offset + i) % period;
+        dst[i] = c < renderedWidth ? columns[c] : 0;
+    }
+}
+
+Marquee::Marquee(int16_t x, uint8_t page, int16_t w) : x(x),
+                                                       page(page),
+                                                       width(w),
+                                                       offset(0),
+                                                       startTime(0)
+{
+}
+
+void Marquee::setText(const char *text, unsigned long now)
+{
+    strip.setText(text);
+    offset = 0;
+    startTime = now;
+}
+
+bool Marquee::update(unsigned long now)
+{
+    if (!scrolls() || now - startTime < START_HOLD_MS)
+    {
+        return false;
+    }
+
+    int16_t period = strip.textWidth() + GAP;
+    int16_t newOffset = ((now - startTime - START_HOLD_MS) / STEP_MS) % period;
+    if (newOffset == offset)
+    {
+        return false;
+    }
+
+    offset = newOffset;
+    return true;
+}
+
+void Marquee::draw(OledDisplay &target) const
+{
+    int16_t period = scrolls() ? strip.textWidth() + GAP : width;
+    strip.blit(target, x, page, width, offset, period);
+    target.markDirty(x, page * 8, x + width - 1, page * 8 + 7);
+}
@@ -0,0 +1,132 @@
+#ifndef OLEDDISPLAY_H
+#define OLEDDISPLAY_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SH110X.h>
+#include "packedBitmap.h"
+
+// I2C clock for the display, the SH1106's rated 400 kHz. Many modules also
+// run at 800 kHz or 1 MHz; opt in with -D OLED_I2C_CLOCK=800000 in
+// platformio.ini after checking the panel for glitches.
+#ifndef OLED_I2C_CLOCK
+#define OLED_I2C_CLOCK 400000
+#endif
+
+// Display flush counters since the last takeFlushStats()
+struct FlushStats
+{
+    unsigned long sent;
+    unsigned long dropped; // Superseded before the flush task got to them
+    unsigned long totalUs;
+    unsigned long maxUs;
+};
+
+// SH1106 driver with direct access to the page-major framebuffer
+// (byte = 8 vertical pixels, buffer[x + page * width]).
+// Drawing goes to the back buffer; present() copies it for a low priority
+// flush task that does the I2C transfer, so rendering never waits on the bus.
+class OledDisplay : public Adafruit_SH1106G
+{
+public:
+    static const uint32_t FLUSH_TASK_STACK = 2048;
+
+    OledDisplay(uint16_t w, uint16_t h, TwoWire *twi, int8_t rstPin, uint32_t i2cClock);
+
+    uint8_t *getBuffer() { return buffer; }
+
+    // Extend the region sent by the next present() call after writing the buffer directly
+    void markDirty(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+
+    // Decode a packed bitmap straight into the framebuffer. Page-aligned draws
+    // replace the covered page bytes, others are OR-ed in.
+    void drawPackedBitmap(int16_t x, int16_t y, const PackedBitmap &bitmap);
+
+    // Start the flush task, after begin(). Until then present() sends inline.
+    bool startFlushTask();
+
+    // Queue the dirty region of the back buffer for the flush task. Returns
+    // false if nothing changed. Never blocks on I2C.
+    bool present();
+
+    // A frame is queued or being sent (keep the CPU out of light sleep)
+    bool flushBusy() const { return framePending || sending; }
+
+    // Number of the last frame present() queued (0 before the first)
+    uint32_t presentedFrame() const { return presentedSeq; }
+
+    // True once frame number 'frame' or a later one is on the panel;
+    // doneUs gets the micros() at which that transfer finished
+    bool frameShown(uint32_t frame, uint32_t &doneUs);
+
+    FlushStats takeFlushStats();
+
+private:
+    static void flushTaskMain(void *arg);
+    void flushLoop();
+    void sendFrame(const uint8_t *frame, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+
+    uint32_t i2cClock;
+    uint8_t *pendingFrame; // Latest presented frame
+    uint8_t *sendingFrame; // Copy owned by the flush task while it sends
+    int16_t pendingX1, pendingY1, pendingX2, pendingY2;
+    uint32_t presentedSeq; // Counts present() calls
+    uint32_t pendingSeq;   // Frame number of pendingFrame
+    uint32_t shownSeq;     // Last frame number fully sent
+    uint32_t shownUs;
+    volatile bool framePending;
+    volatile bool sending;
+    TaskHandle_t flushTask;
+    portMUX_TYPE frameLock;
+    FlushStats stats;
+};
+
+// Off-screen 1-bit strip, one page (8 px) tall, holding a pre-rendered line of text
+class TextStrip : public Adafruit_GFX
+{
+public:
+    static const int16_t MAX_WIDTH = 768; // 128 characters at text size 1
+
+    TextStrip();
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+
+    // Rasterize text once; returns the rendered width in pixels
+    int16_t setText(const char *text);
+    int16_t textWidth() const { return renderedWidth; }
+
+    // Copy w columns starting at offset into a display page, wrapping with a gap
+    void blit(OledDisplay &target, int16_t x, uint8_t page, int16_t w, int16_t offset, int16_t period) const;
+
+private:
+    uint8_t columns[MAX_WIDTH];
+    int16_t renderedWidth;
+};
+
+// Horizontally scrolling text field aligned to a display page
+class Marquee
+{
+public:
+    static const int16_t GAP = 24;                   // Blank pixels between repeats
+    static const unsigned long STEP_MS = 40;         // One pixel per step
+    static const unsigned long START_HOLD_MS = 1500; // Pause before scrolling starts
+
+    Marquee(int16_t x, uint8_t page, int16_t w);
+
+    void setText(const char *text, unsigned long now);
+    bool scrolls() const { return strip.textWidth() > width; }
+
+    // Advance to the offset for 'now'; returns true if the visible window changed
+    bool update(unsigned long now);
+    void draw(OledDisplay &target) const;
+
+private:
+    TextStrip strip;
+    int16_t x;
+    uint8_t page;
+    int16_t width;
+    int16_t offset;
+    unsigned long startTime;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "packedBitmap.h"
+
+// Streams bytes out of a PackBits-style run-length encoded buffer
+class RleReader
+{
+public:
+    RleReader() : data(nullptr), remaining(0), literal(false), value(0) {}
+
+    void reset(const uint8_t *start)
+    {
+        data = start;
+        remaining = 0;
+    }
+
+    uint8_t next()
+    {
+        if (remaining == 0)
+        {
+            uint8_t control = pgm_read_byte(data++);
+            literal = control < 128;
+            remaining = literal ? control + 1 : control - 126;
+            if (!literal)
+                value = pgm_read_byte(data++);
+        }
+
+        remaining--;
+        return literal ? pgm_read_byte(data++) : value;
+    }
+
+private:
+    const uint8_t *data;
+    uint8_t remaining;
+    bool literal;
+    uint8_t value;
+};
+
+void blitPackedBitmap(uint8_t *buffer, int16_t bufferWidth, int16_t bufferHeight,
+                      int16_t x, int16_t y, const PackedBitmap &bitmap)
+{
+    static const int MAX_DELTA_DEPTH = 4;
+
+    // One reader per level of the delta chain
+    RleReader readers[MAX_DELTA_DEPTH];
+    int depth = 0;
+    for (const PackedBitmap *b = &bitmap; b != nullptr && depth < MAX_DELTA_DEPTH; b = b->base)
+    {
+        readers[depth++].reset(b->data);
+    }
+
+    int16_t pages = (bitmap.height + 7) / 8;
+    int16_t bufferPages = bufferHeight / 8;
+    int16_t shift = y & 7;
+    int16_t firstPage = y >> 3;
+
+    for (int16_t page = 0; page < pages; page++)
+    {
+        for (int16_t col = 0; col < bitmap.width; col++)
+        {
+            uint8_t bits = 0;
+            for (int i = 0; i < depth; i++)
+            {
+                bits ^= readers[i].next();
+            }
+
+            int16_t px = x + col;
+            if (px < 0 || px >= bufferWidth)
+                continue;
+
+            int16_t dstPage = firstPage + page;
+            if (shift == 0)
+            {
+                if (dstPage >= 0 && dstPage < bufferPages)
+                    buffer[px + dstPage * bufferWidth] = bits;
+                continue;
+            }
+
+            if (dstPage >= 0 && dstPage < bufferPages)
+                buffer[px + dstPage * bufferWidth] |= bits << shift;
+            if (dstPage + 1 >= 0 && dstPage + 1 < bufferPages)
+                buffer[px + (dstPage + 1) * bufferWidth] |= bits >> (8 - shift);
+        }
+    }
+}
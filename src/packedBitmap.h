@@ -0,0 +1,23 @@
+#ifndef PACKEDBITMAP_H
+#define PACKEDBITMAP_H
+
+#include <Arduino.h>
+
+// RLE-compressed, page-major bitmap generated by tools/build_assets.py.
+// With a base, the data is an XOR delta against the base bitmap.
+struct PackedBitmap
+{
+    uint8_t width;
+    uint8_t height;
+    uint16_t size;
+    const uint8_t *data;
+    const PackedBitmap *base;
+};
+
+// Decode a packed bitmap straight into a page-major framebuffer
+// (byte = 8 vertical pixels, buffer[x + page * bufferWidth]), clipped to it.
+// Page-aligned rows replace the buffer bytes, unaligned ones are ORed in.
+void blitPackedBitmap(uint8_t *buffer, int16_t bufferWidth, int16_t bufferHeight,
+                      int16_t x, int16_t y, const PackedBitmap &bitmap);
+
+#endif
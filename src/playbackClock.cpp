@@ -0,0 +1,104 @@
+#include "playbackClock.h"
+
+PlaybackClock::PlaybackClock() : anchorPositionMs(0),
+                                 anchorMs(0),
+                                 playing(false),
+                                 initialized(false),
+                                 variance(0),
+                                 stats(),
+                                 lastReport(0)
+{
+}
+
+float PlaybackClock::positionAt(unsigned long now) const
+{
+    if (!playing)
+    {
+        return anchorPositionMs;
+    }
+    return anchorPositionMs + (long)(now - anchorMs);
+}
+
+void PlaybackClock::observe(float progressMs, unsigned long sentMs, unsigned long receivedMs, bool nowPlaying, bool stateChanged)
+{
+    // The server read its clock somewhere in the round trip, on average halfway
+    unsigned long rttMs = receivedMs - sentMs;
+    float measuredMs = progressMs + (nowPlaying ? rttMs / 2.0f : 0.0f);
+
+    // Uniform over the round trip: variance rtt^2 / 12
+    float measureVariance = (float)rttMs * rttMs / 12.0f + JITTER_VARIANCE;
+
+    float predictedMs = positionAt(receivedMs);
+    float error = measuredMs - predictedMs;
+    float jump;
+
+    bool snap = !initialized || nowPlaying != playing || fabsf(error) > SNAP_MS ||
+                (stateChanged && fabsf(error) > TIMESTAMP_SNAP_MS);
+    if (snap)
+    {
+        anchorPositionMs = measuredMs;
+        variance = measureVariance;
+        jump = error;
+        stats.snaps++;
+    }
+    else
+    {
+        variance += DRIFT_VARIANCE * (receivedMs - anchorMs) / 1000.0f;
+        float gain = variance / (variance + measureVariance);
+        anchorPositionMs = predictedMs + gain * error;
+        variance *= 1.0f - gain;
+        jump = gain * error;
+    }
+
+    anchorMs = receivedMs;
+    playing = nowPlaying;
+
+    // Snaps are real jumps (skip, seek, first poll), only drift goes in the metric
+    if (initialized && !snap)
+    {
+        stats.polls++;
+        stats.totalErrorMs += fabsf(error);
+        stats.totalJumpMs += fabsf(jump);
+        stats.maxJumpMs = max(stats.maxJumpMs, fabsf(jump));
+        stats.totalRttMs += rttMs;
+    }
+    initialized = true;
+}
+
+void PlaybackClock::reset(float positionMs, unsigned long now, bool nowPlaying)
+{
+    anchorPositionMs = positionMs;
+    anchorMs = now;
+    playing = nowPlaying;
+    initialized = true;
+    variance = JITTER_VARIANCE;
+}
+
+void PlaybackClock::setPlaying(bool nowPlaying, unsigned long now)
+{
+    anchorPositionMs = positionAt(now);
+    anchorMs = now;
+    playing = nowPlaying;
+}
+
+DriftStats PlaybackClock::takeDriftStats()
+{
+    DriftStats taken = stats;
+    stats = DriftStats();
+    return taken;
+}
+
+void PlaybackClock::report()
+{
+    unsigned long now = millis();
+    if (stats.polls == 0 || now - lastReport < REPORT_INTERVAL)
+    {
+        return;
+    }
+
+    DriftStats drift = takeDriftStats();
+    Serial.printf("Position: %lu polls, error avg %.0f ms, correction avg %.0f ms max %.0f ms, rtt avg %lu ms, %lu snaps\n",
+                  drift.polls, drift.totalErrorMs / drift.polls, drift.totalJumpMs / drift.polls, drift.maxJumpMs,
+                  drift.totalRttMs / drift.polls, drift.snaps);
+    lastReport = now;
+}
@@ -0,0 +1,61 @@
+#ifndef PLAYBACKCLOCK_H
+#define PLAYBACKCLOCK_H
+
+#include <Arduino.h>
+
+// Drift counters since the last takeDriftStats(); snaps are not in the sums
+struct DriftStats
+{
+    unsigned long polls;
+    unsigned long snaps;
+    float totalErrorMs; // Prediction error before each correction
+    float totalJumpMs;  // Position change shown by each correction
+    float maxJumpMs;
+    unsigned long totalRttMs;
+};
+
+// Estimates the track position between polls. Each poll's progress_ms is
+// taken as sampled halfway through the request, so half the round trip is
+// added, and a scalar Kalman filter blends it into the running estimate:
+// slow, jittery links move it less than fast ones. Skips, seeks and large
+// errors snap straight to the new position.
+class PlaybackClock
+{
+public:
+    static constexpr float SNAP_MS = 1500.0f;         // Errors beyond this are a jump, not drift
+    static constexpr float TIMESTAMP_SNAP_MS = 250.0f; // Smaller limit when Spotify reports a state change
+    static constexpr float DRIFT_VARIANCE = 400.0f;    // ms^2 the estimate loses per second (20 ms/s)
+    static constexpr float JITTER_VARIANCE = 400.0f;   // ms^2 of server side jitter on top of the round trip
+    static const unsigned long REPORT_INTERVAL = 60000;
+
+    PlaybackClock();
+
+    // Feed a polled progress. sentMs/receivedMs bracket the request, stateChanged
+    // is set when the track or Spotify's state timestamp changed.
+    void observe(float progressMs, unsigned long sentMs, unsigned long receivedMs, bool playing, bool stateChanged);
+
+    // Start over from a known position (seek, shared state)
+    void reset(float positionMs, unsigned long now, bool playing);
+
+    // Pause/resume without a poll, keeps the current position
+    void setPlaying(bool playing, unsigned long now);
+
+    float positionAt(unsigned long now) const;
+
+    DriftStats takeDriftStats();
+
+    // Drift metric over serial: error before each correction and the jump shown
+    void report();
+
+private:
+    float anchorPositionMs;
+    unsigned long anchorMs;
+    bool playing;
+    bool initialized;
+    float variance; // Of the anchor position, ms^2
+
+    DriftStats stats;
+    unsigned long lastReport;
+};
+
+#endif
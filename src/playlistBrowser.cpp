@@ -0,0 +1,254 @@
+#include "playlistBrowser.h"
+#include "spotifyClient.h"
+#include "jsonPool.h"
+#include "requestScheduler.h"
+
+PlaylistBrowser playlistBrowser;
+
+// Filtered pages only hold ids and names, so a small arena is enough
+static uint8_t browseArena[4096] __attribute__((aligned(8)));
+static JsonPool browsePool(browseArena, sizeof(browseArena), "browse");
+
+static const JsonDocument &playlistsFilter()
+{
+    static JsonDocument filter;
+    if (filter.isNull())
+    {
+        filter["total"] = true;
+        filter["items"][0]["id"] = true;
+        filter["items"][0]["name"] = true;
+    }
+    return filter;
+}
+
+static const JsonDocument &tracksFilter()
+{
+    static JsonDocument filter;
+    if (filter.isNull())
+    {
+        filter["total"] = true;
+        filter["items"][0]["track"]["id"] = true;
+        filter["items"][0]["track"]["name"] = true;
+    }
+    return filter;
+}
+
+PlaylistBrowser::PlaylistBrowser() : useCounter(0),
+                                     showingTracks(false),
+                                     playlistRow(0),
+                                     total(-1),
+                                     wantedOffset(-1),
+                                     lastFailure(0)
+{
+    clearPages();
+}
+
+void PlaylistBrowser::openPlaylists()
+{
+    showingTracks = false;
+    playlistRow = 0;
+    clearPages();
+}
+
+bool PlaylistBrowser::openPlaylist(int index)
+{
+    const Item *item = findItem(index);
+    if (item == nullptr || item->id.length() == 0)
+    {
+        return false;
+    }
+
+    playlistId = item->id;
+    playlistName = item->name;
+    playlistRow = index;
+    showingTracks = true;
+    clearPages();
+    return true;
+}
+
+int PlaylistBrowser::closePlaylist()
+{
+    showingTracks = false;
+    clearPages();
+    return playlistRow;
+}
+
+bool PlaylistBrowser::playTrack(int index)
+{
+    String uri = "spotify:playlist:" + String(playlistId.c_str());
+    return spotifyConnection.playContext(uri.c_str(), index);
+}
+
+const char *PlaylistBrowser::title() const
+{
+    return showingTracks ? playlistName.c_str() : "Playlists";
+}
+
+const char *PlaylistBrowser::label(int index)
+{
+    if (total < 0)
+    {
+        return "Loading...";
+    }
+
+    const Item *item = findItem(index);
+    if (item != nullptr)
+    {
+        return item->name.c_str();
+    }
+
+    // The loop fetches the page; the row fills in on the next frame
+    int offset = index - index % PAGE_SIZE;
+    if (findPage(offset) != nullptr)
+    {
+        return ""; // Past the end of a short page
+    }
+    if (wantedOffset < 0)
+    {
+        wantedOffset = offset;
+    }
+    return "...";
+}
+
+// Page service() would fetch next, -1 if none
+int PlaylistBrowser::nextOffset(int cursor)
+{
+    if (lastFailure != 0 && millis() - lastFailure < RETRY_INTERVAL)
+    {
+        return -1;
+    }
+
+    int offset = wantedOffset;
+    if (total < 0)
+    {
+        offset = 0;
+    }
+    else if (offset < 0)
+    {
+        // Prefetch the neighbouring page as the cursor nears either edge
+        int pageStart = cursor - cursor % PAGE_SIZE;
+        int next = pageStart + PAGE_SIZE;
+        int previous = pageStart - PAGE_SIZE;
+        if (cursor >= next - PREFETCH_MARGIN && next < total && findPage(next) == nullptr)
+        {
+            offset = next;
+        }
+        else if (cursor < pageStart + PREFETCH_MARGIN && previous >= 0 && findPage(previous) == nullptr)
+        {
+            offset = previous;
+        }
+    }
+    return offset;
+}
+
+bool PlaylistBrowser::service(int cursor)
+{
+    int offset = nextOffset(cursor);
+    if (offset < 0)
+    {
+        return false;
+    }
+
+    wantedOffset = -1;
+    if (!fetchPage(offset))
+    {
+        // Giving way to a button press is no reason to back off
+        if (!requestScheduler.aborted())
+        {
+            lastFailure = millis();
+        }
+        return false;
+    }
+    lastFailure = 0;
+    return true;
+}
+
+PlaylistBrowser::Page *PlaylistBrowser::findPage(int offset)
+{
+    for (int i = 0; i < CACHE_PAGES; i++)
+    {
+        if (pages[i].offset == offset)
+        {
+            pages[i].lastUsed = ++useCounter;
+            return &pages[i];
+        }
+    }
+    return nullptr;
+}
+
+const PlaylistBrowser::Item *PlaylistBrowser::findItem(int index)
+{
+    Page *page = findPage(index - index % PAGE_SIZE);
+    if (page == nullptr || index % PAGE_SIZE >= page->count)
+    {
+        return nullptr;
+    }
+    return &page->items[index % PAGE_SIZE];
+}
+
+bool PlaylistBrowser::fetchPage(int offset)
+{
+    String query = "limit=" + String(PAGE_SIZE) + "&offset=" + String(offset);
+    String path;
+    if (showingTracks)
+    {
+        // The tracks endpoint can trim the response server side as well
+        path = "/v1/playlists/" + String(playlistId.c_str()) + "/tracks?" + query + "&fields=total,items(track(id,name))";
+    }
+    else
+    {
+        path = "/v1/me/playlists?" + query;
+    }
+
+    unsigned long start = millis();
+    JsonPoolLease lease(browsePool);
+    JsonDocument &doc = lease.doc();
+    if (!httpsSession.requestJson("api.spotify.com", path.c_str(), spotifyConnection.getAuthHeader(), doc,
+                                   showingTracks ? tracksFilter() : playlistsFilter()))
+    {
+        Serial.println("Failed to fetch browse page at " + String(offset));
+        return false;
+    }
+
+    // Reuse the least recently used slot
+    Page *page = &pages[0];
+    for (int i = 1; i < CACHE_PAGES && page->offset >= 0; i++)
+    {
+        if (pages[i].offset < 0 || pages[i].lastUsed < page->lastUsed)
+        {
+            page = &pages[i];
+        }
+    }
+
+    page->offset = offset;
+    page->count = 0;
+    page->lastUsed = ++useCounter;
+    for (JsonObject entry : doc["items"].as<JsonArray>())
+    {
+        if (page->count >= PAGE_SIZE)
+            break;
+
+        // Playlist entries wrap the track; local files have no ID but still play by position
+        JsonObject item = showingTracks ? entry["track"].as<JsonObject>() : entry;
+        page->items[page->count].id = item["id"].as<const char *>();
+        page->items[page->count].name = item["name"].as<const char *>();
+        page->count++;
+    }
+    total = doc["total"] | 0;
+
+    Serial.printf("Browse page %d: %d items of %d in %lu ms\n", offset, page->count, total, millis() - start);
+    return true;
+}
+
+void PlaylistBrowser::clearPages()
+{
+    for (int i = 0; i < CACHE_PAGES; i++)
+    {
+        pages[i].offset = -1;
+        pages[i].count = 0;
+        pages[i].lastUsed = 0;
+    }
+    total = -1;
+    wantedOffset = -1;
+    lastFailure = 0;
+}
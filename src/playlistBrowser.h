@@ -0,0 +1,86 @@
+#ifndef PLAYLISTBROWSER_H
+#define PLAYLISTBROWSER_H
+
+#include <Arduino.h>
+#include "fixedString.h"
+
+// Browses the user's playlists and a playlist's tracks. Pages are fetched
+// lazily with limit/offset into a small LRU cache, so memory stays the same
+// no matter how long the list is; only rows that are on screen ask for labels.
+class PlaylistBrowser
+{
+public:
+    static const int PAGE_SIZE = 20;
+    static const int CACHE_PAGES = 4;
+    static const int PREFETCH_MARGIN = 5;             // Rows from a page edge that trigger a prefetch
+    static const unsigned long RETRY_INTERVAL = 2000; // Wait after a failed fetch
+
+    PlaylistBrowser();
+
+    // Start at the playlist list, dropping cached pages
+    void openPlaylists();
+
+    bool atTracks() const { return showingTracks; }
+
+    // Enter the playlist at `index`; false if its page is not loaded yet
+    bool openPlaylist(int index);
+
+    // Back to the playlist list; returns the row to select there
+    int closePlaylist();
+
+    // Play the current playlist starting at track `index`
+    bool playTrack(int index);
+
+    const char *title() const;
+
+    // Item count, 1 until the first page tells us the total
+    int count() const { return total < 0 ? 1 : total; }
+
+    // Label for row `index`; missing pages are requested, never fetched here
+    const char *label(int index);
+
+    // Fetch at most one wanted or prefetched page; true if the list changed
+    bool service(int cursor);
+
+    // True if service() has a page to fetch now
+    bool due(int cursor) { return nextOffset(cursor) >= 0; }
+
+    // True while a page still has to be fetched
+    bool pending() const { return total < 0 || wantedOffset >= 0; }
+
+private:
+    int nextOffset(int cursor);
+
+    struct Item
+    {
+        FixedString<23> id;
+        FixedString<48> name;
+    };
+
+    struct Page
+    {
+        int offset; // -1 when the slot is free
+        int count;
+        uint32_t lastUsed;
+        Item items[PAGE_SIZE];
+    };
+
+    Page *findPage(int offset);
+    const Item *findItem(int index);
+    bool fetchPage(int offset);
+    void clearPages();
+
+    Page pages[CACHE_PAGES];
+    uint32_t useCounter;
+    bool showingTracks;
+    FixedString<23> playlistId;
+    FixedString<48> playlistName;
+    int playlistRow;
+    int total;
+    int wantedOffset;
+    unsigned long lastFailure;
+};
+
+extern PlaylistBrowser playlistBrowser;
+
+#endif
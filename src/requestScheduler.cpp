@@ -0,0 +1,144 @@
+#include "requestScheduler.h"
+
+RequestScheduler requestScheduler;
+
+static const char *classNames[REQUEST_CLASS_COUNT] = {"command", "token", "poll", "background"};
+
+RequestScheduler::RequestScheduler() : jobCount(0),
+                                       running(false),
+                                       current(REQUEST_COMMAND),
+                                       abortedCurrent(false),
+                                       preemptCheck(nullptr),
+                                       lastReport(0)
+{
+    memset(classDue, 0, sizeof(classDue));
+    memset(dueSince, 0, sizeof(dueSince));
+    memset(stats, 0, sizeof(stats));
+}
+
+void RequestScheduler::addJob(RequestClass requestClass, bool (*due)(), void (*run)())
+{
+    if (jobCount >= MAX_JOBS)
+    {
+        return;
+    }
+
+    // Keep the list sorted by class, stable within a class
+    int slot = jobCount;
+    while (slot > 0 && jobs[slot - 1].requestClass > requestClass)
+    {
+        jobs[slot] = jobs[slot - 1];
+        slot--;
+    }
+    jobs[slot] = {requestClass, due, run};
+    jobCount++;
+}
+
+void RequestScheduler::markDue(RequestClass requestClass, unsigned long sinceMs)
+{
+    if (!classDue[requestClass] || (long)(sinceMs - dueSince[requestClass]) < 0)
+    {
+        dueSince[requestClass] = sinceMs;
+    }
+    classDue[requestClass] = true;
+}
+
+bool RequestScheduler::run()
+{
+    unsigned long now = millis();
+
+    // Check every job, so waiting classes start their clock even when
+    // something more urgent runs first
+    bool anyDue[REQUEST_CLASS_COUNT] = {false};
+    int next = -1;
+    for (int i = 0; i < jobCount; i++)
+    {
+        if (!jobs[i].due())
+            continue;
+
+        RequestClass requestClass = jobs[i].requestClass;
+        anyDue[requestClass] = true;
+        if (!classDue[requestClass])
+        {
+            classDue[requestClass] = true;
+            dueSince[requestClass] = now;
+        }
+        if (next < 0)
+        {
+            next = i;
+        }
+    }
+
+    // Input that did not turn into a request (menu moves) does not count
+    for (int i = 0; i < REQUEST_CLASS_COUNT; i++)
+    {
+        classDue[i] &= anyDue[i];
+    }
+
+    if (next < 0)
+    {
+        return false;
+    }
+
+    const Job &job = jobs[next];
+    ClassStats &classStats = stats[job.requestClass];
+    unsigned long delayMs = now - dueSince[job.requestClass];
+    classStats.runs++;
+    classStats.totalDelayMs += delayMs;
+    classStats.maxDelayMs = max(classStats.maxDelayMs, delayMs);
+    classDue[job.requestClass] = false;
+
+    running = true;
+    current = job.requestClass;
+    abortedCurrent = false;
+    job.run();
+    running = false;
+    return true;
+}
+
+void RequestScheduler::setPreemptCheck(bool (*check)())
+{
+    preemptCheck = check;
+}
+
+bool RequestScheduler::shouldAbort(bool written)
+{
+    if (!running || current < REQUEST_POLL || preemptCheck == nullptr || !preemptCheck())
+    {
+        return false;
+    }
+
+    if (!abortedCurrent)
+    {
+        stats[current].aborts++;
+        if (written)
+        {
+            stats[current].drops++;
+        }
+        Serial.printf("Aborting %s request for user input%s\n", classNames[current], written ? ", dropping the connection" : "");
+    }
+    abortedCurrent = true;
+    return true;
+}
+
+void RequestScheduler::report()
+{
+    unsigned long now = millis();
+    if (now - lastReport < REPORT_INTERVAL)
+    {
+        return;
+    }
+    lastReport = now;
+
+    Serial.println("Request queueing delay:");
+    for (int i = 0; i < REQUEST_CLASS_COUNT; i++)
+    {
+        ClassStats &classStats = stats[i];
+        if (classStats.runs == 0)
+            continue;
+
+        Serial.printf(" %-10s %4lu runs, avg %lu ms, max %lu ms, %lu aborted (%lu in flight)\n", classNames[i], classStats.runs,
+                      classStats.totalDelayMs / classStats.runs, classStats.maxDelayMs, classStats.aborts, classStats.drops);
+    }
+    memset(stats, 0, sizeof(stats));
+}
@@ -0,0 +1,83 @@
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <Arduino.h>
+
+// Priority classes for Spotify requests, most urgent first
+enum RequestClass : uint8_t
+{
+    REQUEST_COMMAND,    // Player commands from buttons, encoder and LAN clients
+    REQUEST_TOKEN,      // Access token refresh
+    REQUEST_POLL,       // Playback state polls
+    REQUEST_BACKGROUND, // Prefetch and metadata (playlist pages, device list)
+    REQUEST_CLASS_COUNT
+};
+
+// Runs the loop's network work one job per pass, highest class first, so
+// input is handled between background requests instead of after all of them.
+// Poll and background requests give way when a button is pressed, before
+// they are sent or while they wait for the response. Reports the queueing
+// delay per class.
+class RequestScheduler
+{
+public:
+    static const int MAX_JOBS = 8;
+    static const unsigned long REPORT_INTERVAL = 60000;
+
+    RequestScheduler();
+
+    // Jobs run by class, then in the order they were added
+    void addJob(RequestClass requestClass, bool (*due)(), void (*run)());
+
+    // Work of this class exists since sinceMs (e.g. the time of a button press)
+    void markDue(RequestClass requestClass, unsigned long sinceMs);
+
+    // Run the most urgent due job; false if nothing was due
+    bool run();
+
+    // Checks for user input waiting, used to preempt background requests
+    void setPreemptCheck(bool (*check)());
+
+    // Called before a request is written and while waiting for its response.
+    // True if it is a poll or background request and input is pending. A
+    // written request that gives way leaves the connection out of step, the
+    // caller closes it; those are counted as drops.
+    bool shouldAbort(bool written);
+
+    // The job that just ran gave way to user input
+    bool aborted() const { return abortedCurrent; }
+
+    void report();
+
+private:
+    struct Job
+    {
+        RequestClass requestClass;
+        bool (*due)();
+        void (*run)();
+    };
+
+    struct ClassStats
+    {
+        unsigned long runs;
+        unsigned long totalDelayMs;
+        unsigned long maxDelayMs;
+        unsigned long aborts;
+        unsigned long drops; // Aborted after the request was written
+    };
+
+    Job jobs[MAX_JOBS];
+    int jobCount;
+    bool classDue[REQUEST_CLASS_COUNT];
+    unsigned long dueSince[REQUEST_CLASS_COUNT];
+    ClassStats stats[REQUEST_CLASS_COUNT];
+    bool running;
+    RequestClass current;
+    bool abortedCurrent;
+    bool (*preemptCheck)();
+    unsigned long lastReport;
+};
+
+extern RequestScheduler requestScheduler;
+
+#endif
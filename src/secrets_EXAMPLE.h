@@ -11,6 +11,10 @@
 #define CLIENT_SECRET "SpotifyClientSecret"
 #define REDIRECT_URI "SpotifyRedirectURI"
 
+// Secret for LAN API commands (X-Api-Token header). Pick your own;
+// without it the API only serves /api/state and /api/events.
+// #define LAN_API_TOKEN "ChangeMe"
+
 // Timing constants
 #define API_REFRESH_INTERVAL 5000 // 5 seconds
 #define VOLUME_UPDATE_THRESHOLD 2 // Minimum volume change to update
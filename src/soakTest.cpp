@@ -0,0 +1,123 @@
+#include "soakTest.h"
+
+SoakMonitor soakMonitor;
+
+SoakMonitor::SoakMonitor() : totals(),
+                             reconnectsThisHour(0),
+                             hourStart(0),
+                             failingSince(0),
+                             heapBaseline(0),
+                             lastReport(0),
+                             violations(0)
+{
+}
+
+void SoakMonitor::recordRequest(bool ok)
+{
+    unsigned long now = millis();
+    totals.requests++;
+
+    if (!ok)
+    {
+        totals.failures++;
+        if (failingSince == 0)
+        {
+            failingSince = max(now, 1UL);
+        }
+        return;
+    }
+
+    // First success after a failure streak
+    if (failingSince != 0)
+    {
+        totals.maxRecoveryMs = max(totals.maxRecoveryMs, now - failingSince);
+        totals.recoveries++;
+        failingSince = 0;
+    }
+}
+
+void SoakMonitor::recordStatus(int statusCode)
+{
+    if (statusCode >= 500)
+        totals.status5xx++;
+    else if (statusCode >= 400)
+        totals.status4xx++;
+}
+
+void SoakMonitor::recordReconnect()
+{
+    unsigned long now = millis();
+    if (now - hourStart >= 3600000UL)
+    {
+        hourStart = now;
+        reconnectsThisHour = 0;
+    }
+
+    totals.reconnects++;
+    reconnectsThisHour++;
+    totals.maxReconnectsPerHour = max(totals.maxReconnectsPerHour, reconnectsThisHour);
+}
+
+bool SoakMonitor::checkInvariants(uint32_t freeHeap)
+{
+    bool ok = true;
+    unsigned long now = millis();
+
+    if (heapBaseline != 0 && freeHeap + MAX_HEAP_DROP < heapBaseline)
+    {
+        Serial.printf("  FAIL heap: %u bytes free, baseline %u\n", freeHeap, heapBaseline);
+        ok = false;
+    }
+    if (totals.maxReconnectsPerHour > MAX_RECONNECTS_PER_HOUR)
+    {
+        Serial.printf("  FAIL reconnects: %lu in one hour, limit %lu\n", totals.maxReconnectsPerHour, MAX_RECONNECTS_PER_HOUR);
+        ok = false;
+    }
+
+    // A streak still open counts too
+    unsigned long recoveryMs = totals.maxRecoveryMs;
+    if (failingSince != 0)
+    {
+        recoveryMs = max(recoveryMs, now - failingSince);
+    }
+    if (recoveryMs > MAX_RECOVERY_MS)
+    {
+        Serial.printf("  FAIL recovery: %lu ms, limit %lu ms\n", recoveryMs, MAX_RECOVERY_MS);
+        ok = false;
+    }
+
+    return ok;
+}
+
+void SoakMonitor::report()
+{
+    unsigned long now = millis();
+    uint32_t freeHeap = ESP.getFreeHeap();
+
+    // Baseline once startup allocations (TLS, server, pools) have settled
+    if (heapBaseline == 0 && now > WARMUP)
+    {
+        heapBaseline = freeHeap;
+    }
+
+    if (now - lastReport < REPORT_INTERVAL)
+        return;
+    lastReport = now;
+
+    Serial.printf("Soak: up %lu min, %lu requests, %lu failed (%lu 4xx, %lu 5xx)\n",
+                  now / 60000, totals.requests, totals.failures, totals.status4xx, totals.status5xx);
+    Serial.printf("  reconnects %lu (max %lu/h), recoveries %lu (max %lu ms)\n",
+                  totals.reconnects, totals.maxReconnectsPerHour, totals.recoveries, totals.maxRecoveryMs);
+    Serial.printf("  heap %u free, %u min, %u largest block, baseline %u\n",
+                  freeHeap, ESP.getMinFreeHeap(), ESP.getMaxAllocHeap(), heapBaseline);
+
+    if (checkInvariants(freeHeap))
+    {
+        Serial.println("  PASS");
+    }
+    else
+    {
+        violations++;
+        Serial.printf("  %lu failing reports so far\n", violations);
+    }
+}
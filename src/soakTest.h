@@ -0,0 +1,57 @@
+#ifndef SOAKTEST_H
+#define SOAKTEST_H
+
+#include <Arduino.h>
+
+// Counters since boot
+struct SoakStats
+{
+    unsigned long requests;
+    unsigned long failures;
+    unsigned long status4xx;
+    unsigned long status5xx;
+    unsigned long reconnects;
+    unsigned long maxReconnectsPerHour;
+    unsigned long recoveries;    // Failure streaks that ended in a success
+    unsigned long maxRecoveryMs; // Longest of them
+};
+
+// Tracks long-run health of the Spotify connection and checks invariants:
+// the heap does not shrink, reconnects per hour stay bounded and every
+// failure streak recovers in time. Prints a summary periodically. The
+// native test under test/test_https_soak holds a mock endpoint with
+// injected faults to the same invariants.
+class SoakMonitor
+{
+public:
+    static const unsigned long REPORT_INTERVAL = 600000;   // 10 minutes
+    static const unsigned long WARMUP = 120000;            // Heap baseline is taken after this
+    static const uint32_t MAX_HEAP_DROP = 8192;            // Bytes of free heap lost before it counts as a leak
+    static const unsigned long MAX_RECONNECTS_PER_HOUR = 120;
+    static const unsigned long MAX_RECOVERY_MS = 30000;
+
+    SoakMonitor();
+
+    void recordRequest(bool ok);
+    void recordStatus(int statusCode);
+    void recordReconnect();
+    void report();
+
+    // Prints each broken invariant; an open failure streak counts too
+    bool checkInvariants(uint32_t freeHeap);
+
+    SoakStats stats() const { return totals; }
+
+private:
+    SoakStats totals;
+    unsigned long reconnectsThisHour;
+    unsigned long hourStart;
+    unsigned long failingSince; // 0 while healthy
+    uint32_t heapBaseline;
+    unsigned long lastReport;
+    unsigned long violations;
+};
+
+extern SoakMonitor soakMonitor;
+
+#endif
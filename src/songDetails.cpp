@@ -0,0 +1,48 @@
+#include "songDetails.h"
+
+const JsonDocument &playerFilter()
+{
+    static JsonDocument filter;
+    if (filter.isNull())
+    {
+        filter["device"]["is_active"] = true;
+        filter["device"]["supports_volume"] = true;
+        filter["device"]["volume_percent"] = true;
+        filter["progress_ms"] = true;
+        filter["timestamp"] = true;
+        filter["is_playing"] = true;
+        filter["item"]["name"] = true;
+        filter["item"]["uri"] = true;
+        filter["item"]["duration_ms"] = true;
+        filter["item"]["artists"][0]["name"] = true;
+    }
+    return filter;
+}
+
+void readSongDetails(JsonVariantConst item, SongDetails &song)
+{
+    if (item.isNull())
+    {
+        song.artist = "Unknown Artist";
+        song.song = "No Song Playing";
+        song.durationMs = 0;
+        song.Id = "";
+        return;
+    }
+
+    const char *artistName = item["artists"][0]["name"].as<const char *>();
+    song.artist = artistName ? artistName : "Unknown Artist";
+    song.song = item["name"].as<const char *>();
+    song.durationMs = item["duration_ms"].as<int>();
+
+    // Only tracks can be liked, episodes and local files get no ID
+    const char *uri = item["uri"].as<const char *>();
+    if (uri && strncmp(uri, "spotify:track:", 14) == 0)
+    {
+        song.Id = uri + 14;
+    }
+    else
+    {
+        song.Id = "";
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef SONGDETAILS_H
+#define SONGDETAILS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "fixedString.h"
+
+// Song details struct (fixed capacity, filled without heap allocations)
+struct SongDetails
+{
+    int durationMs;
+    FixedString<96> album;
+    FixedString<96> artist;
+    FixedString<128> song;
+    FixedString<23> Id;
+    bool isLiked;
+};
+
+// Fields of /v1/me/player the player state is read from, built once
+const JsonDocument &playerFilter();
+
+// Copy the "item" of a player response into song, straight out of the
+// document. A null item (nothing playing) gives the placeholder texts.
+// isLiked is left to the caller.
+void readSongDetails(JsonVariantConst item, SongDetails &song);
+
+#endif
@@ -1,4 +1,9 @@
 #include "spotifyClient.h"
+#include "latencyTrace.h"
+#include "jsonPool.h"
+#include "multicastSync.h"
+#include "requestScheduler.h"
+#include "dnsCache.h"
 
 // Spotify Root CA Certificate
 const char *spotify_root_ca PROGMEM =
@@ -31,7 +36,11 @@ const char *spotify_root_ca PROGMEM =
     "JCqVJUzKoZHm1Lesh3Sz8W2jmdv51b2EQJ8HmA==\n"
     "-----END CERTIFICATE-----\n";
 
+static bool connectSpotify(const char *host);
+
 // Global instances
+static WiFiClientSecure secureClient;
+HttpsSession httpsSession(secureClient, connectSpotify);
 SpotConn spotifyConnection;
 SSLCert *cert;
 HTTPSServer *secureServer;
@@ -44,20 +53,80 @@ void setDrawScreenCallback(void (*callback)())
     externalDrawScreen = callback;
 }
 
+// Per-endpoint JSON documents, each parsing into its own static arena
+static uint8_t tokenArena[3072] __attribute__((aligned(8)));
+static uint8_t playerArena[3072] __attribute__((aligned(8)));
+static uint8_t queueArena[3072] __attribute__((aligned(8)));
+static uint8_t likedArena[2048] __attribute__((aligned(8)));
+static uint8_t devicesArena[2048] __attribute__((aligned(8)));
+
+static JsonPool tokenPool(tokenArena, sizeof(tokenArena), "token");
+static JsonPool playerPool(playerArena, sizeof(playerArena), "player");
+static JsonPool queuePool(queueArena, sizeof(queueArena), "queue");
+static JsonPool likedPool(likedArena, sizeof(likedArena), "liked");
+static JsonPool devicesPool(devicesArena, sizeof(devicesArena), "devices");
+
+// Filters are built once and reused for every parse (playerFilter() is in songDetails.cpp)
+static const JsonDocument &queueFilter()
+{
+    static JsonDocument filter;
+    if (filter.isNull())
+    {
+        filter["queue"][0]["id"] = true;
+        filter["queue"][0]["type"] = true;
+    }
+    return filter;
+}
+
+static const JsonDocument &devicesFilter()
+{
+    static JsonDocument filter;
+    if (filter.isNull())
+    {
+        filter["devices"][0]["id"] = true;
+        filter["devices"][0]["name"] = true;
+        filter["devices"][0]["type"] = true;
+        filter["devices"][0]["is_active"] = true;
+        filter["devices"][0]["is_restricted"] = true;
+    }
+    return filter;
+}
+
 // SpotConn constructor
 SpotConn::SpotConn() : accessTokenSet(false),
                        tokenStartTime(0),
                        tokenExpireTime(0),
-                       currentSongPositionMs(0),
-                       lastSongPositionMs(0),
+                       stateTimestamp(0),
                        currVol(0),
                        isPlaying(false),
                        isActive(false),
                        volCtrl(false),
                        volume(0),
-                       lastConnectionTime(0),
-                       requestCount(0)
+                       lastRefreshAttempt(0),
+                       lastTrackInfoTime(0),
+                       trackInfoPending(false),
+                       avoidedTrackInfoRequests(0),
+                       volumeTarget(0),
+                       volumePending(false),
+                       lastVolumeSent(0),
+                       lastVolumeChange(0),
+                       scrubbing(false),
+                       scrubPositionMs(0),
+                       seekTarget(0),
+                       seekPending(false),
+                       lastSeekSent(0),
+                       commandCount(0),
+                       pipelineCommands(PIPELINE_COMMANDS),
+                       journalCount(0),
+                       lastJournalReplay(0),
+                       deviceCount(0),
+                       devicesFetchedAt(0),
+                       fastPollUntil(0),
+                       likedPending(false),
+                       likedFailedAt(0),
+                       likedCacheNext(0)
 {
+    memset(likedCache, 0, sizeof(likedCache));
     secureClient.setCACert(spotify_root_ca);
     secureClient.setTimeout(10000);
     secureClient.setHandshakeTimeout(10000);
@@ -66,7 +135,8 @@ SpotConn::SpotConn() : accessTokenSet(false),
 // SpotConn method implementations
 bool SpotConn::getUserCode(const String &serverCode)
 {
-    JsonDocument doc;
+    JsonPoolLease lease(tokenPool);
+    JsonDocument &doc = lease.doc();
     String response;
 
     String auth = "Basic " + base64::encode(
@@ -82,7 +152,7 @@ bool SpotConn::getUserCode(const String &serverCode)
         serverCode +
         "&redirect_uri=" + String(REDIRECT_URI);
 
-    bool ok = httpsRequest(
+    bool ok = httpsSession.request(
         "accounts.spotify.com",
         "/api/token",
         "POST",
@@ -106,6 +176,7 @@ bool SpotConn::getUserCode(const String &serverCode)
 
     accessToken = doc["access_token"].as<String>();
     refreshToken = doc["refresh_token"].as<String>();
+    bearerHeader = "Authorization: Bearer " + accessToken + "\r\n";
     tokenExpireTime = doc["expires_in"].as<int>();
     tokenStartTime = millis();
     accessTokenSet = true;
@@ -118,10 +189,13 @@ bool SpotConn::getUserCode(const String &serverCode)
 
 bool SpotConn::refreshAuth()
 {
-    JsonDocument doc;
+    JsonPoolLease lease(tokenPool);
+    JsonDocument &doc = lease.doc();
     String response;
 
-    accessTokenSet = false;
+    // The old token stays usable until this succeeds; a failed refresh
+    // during a dropped socket must not log the device out
+    lastRefreshAttempt = millis();
 
     String auth = "Basic " + base64::encode(
                                  String(CLIENT_ID) + ":" + String(CLIENT_SECRET));
@@ -135,7 +209,7 @@ bool SpotConn::refreshAuth()
         "&refresh_token=" +
         refreshToken;
 
-    bool ok = httpsRequest(
+    bool ok = httpsSession.request(
         "accounts.spotify.com",
         "/api/token",
         "POST",
@@ -158,6 +232,7 @@ bool SpotConn::refreshAuth()
     }
 
     accessToken = doc["access_token"].as<String>();
+    bearerHeader = "Authorization: Bearer " + accessToken + "\r\n";
 
     // Optional refresh_token (Spotify sometimes omits it)
     if (!doc["refresh_token"].isNull())
@@ -168,34 +243,98 @@ bool SpotConn::refreshAuth()
     tokenExpireTime = doc["expires_in"].as<int>();
     tokenStartTime = millis();
     accessTokenSet = true;
+    httpsSession.authRejected = false;
 
     Serial.println("Refreshed access token: " + accessToken);
     return true;
 }
 
+// Token close to expiry or rejected, and no refresh attempted too recently
+bool SpotConn::refreshDue()
+{
+    bool expiring = (millis() - tokenStartTime) / 1000 > (unsigned long)max(tokenExpireTime - 60, 0);
+    return (expiring || httpsSession.authRejected) && millis() - lastRefreshAttempt > TOKEN_RETRY_INTERVAL;
+}
+
+// Ask for a state refresh. Requests made while one is already pending share
+// the single /v1/me/player call made by the next serviceTrackInfo().
+void SpotConn::requestTrackInfo()
+{
+    if (trackInfoPending)
+    {
+        avoidedTrackInfoRequests++;
+        Serial.println("Track info refresh coalesced (" + String(avoidedTrackInfoRequests) + " avoided)");
+        return;
+    }
+    trackInfoPending = true;
+}
+
+// Any player command ready to go out (queued, streamed or journaled)
+bool SpotConn::commandsDue()
+{
+    return commandCount > 0 || volumeDue() || seekDue() || journalDue();
+}
+
+// Send everything commandsDue() reported
+void SpotConn::serviceCommands()
+{
+    serviceVolume();
+    serviceSeek();
+    flushCommands();
+    serviceJournal();
+}
+
+// Perform the pending state refresh, if any
+bool SpotConn::serviceTrackInfo()
+{
+    if (!trackInfoPending)
+    {
+        return true;
+    }
+    return getTrackInfo();
+}
+
 bool SpotConn::getTrackInfo()
 {
-    JsonDocument doc;
-    String response;
-    bool success = false;
+    // Reused across polls so its capacity sticks around
+    static String response;
 
-    String headers =
-        "Authorization: Bearer " + accessToken + "\r\n";
+    // Everyone waiting on a refresh is served by this request
+    trackInfoPending = false;
+    lastTrackInfoTime = millis();
 
-    bool ok = httpsRequest(
+    bool ok = httpsSession.request(
         "api.spotify.com",
         "/v1/me/player",
         "GET",
-        headers,
+        bearerHeader,
         "",
         response);
 
     if (!ok)
     {
         Serial.println("HTTPS player request failed");
+        if (requestScheduler.aborted())
+        {
+            trackInfoPending = true; // Gave way to a button press, poll again right after
+        }
         return false;
     }
 
+    return applyPlayerState(response);
+}
+
+// Update playback state from a /v1/me/player response body
+bool SpotConn::applyPlayerState(const String &response)
+{
+    JsonPoolLease lease(playerPool);
+    JsonDocument &doc = lease.doc();
+    bool success = false;
+
+    // Taken first, any later request overwrites them
+    unsigned long sentMs = httpsSession.requestSentMs();
+    unsigned long receivedMs = httpsSession.responseStartMs();
+
     // Spotify returns 204 with an empty body
     if (response.length() == 0)
     {
@@ -203,11 +342,12 @@ bool SpotConn::getTrackInfo()
         isActive = false;
         volCtrl = false;
         success = true;
+        latencyTracer.mark(TRACE_STATE_UPDATE);
         externalDrawScreen();
         return true;
     }
 
-    DeserializationError error = deserializeJson(doc, response);
+    DeserializationError error = deserializeJson(doc, response, DeserializationOption::Filter(playerFilter()));
     if (error)
     {
         Serial.print(F("deserializeJson() failed: "));
@@ -223,6 +363,12 @@ bool SpotConn::getTrackInfo()
         volCtrl = device["supports_volume"].as<bool>();
         volume = device["volume_percent"].as<int>();
 
+        // Re-sync the local volume unless the user is still changing it
+        if (!volumePending && millis() - lastVolumeChange > VOLUME_SETTLE_TIME)
+        {
+            currVol = volume;
+        }
+
         Serial.print("Spotify Status: ");
         Serial.println(isActive);
     }
@@ -233,50 +379,26 @@ bool SpotConn::getTrackInfo()
     }
 
     // -------- PROGRESS --------
-    currentSongPositionMs =
+    float progressMs =
         doc["progress_ms"].is<int>()
             ? doc["progress_ms"].as<int>()
             : 0;
+    uint64_t timestamp = doc["timestamp"] | (uint64_t)0;
+    FixedString<23> previousId = currentSong.Id;
 
     // -------- SONG ITEM --------
-    if (!doc["item"].isNull())
-    {
-        JsonObject item = doc["item"];
+    readSongDetails(doc["item"], currentSong);
 
-        // Artist
-        if (!item["artists"].isNull())
-        {
-            JsonArray artists = item["artists"].as<JsonArray>();
-            currentSong.artist =
-                (!artists.isNull() && artists.size() > 0)
-                    ? artists[0]["name"].as<String>()
-                    : "Unknown Artist";
-        }
-        else
-        {
-            currentSong.artist = "Unknown Artist";
-        }
-
-        // Song name
-        currentSong.song = item["name"].as<String>();
-
-        // Duration
-        currentSong.durationMs = item["duration_ms"].as<int>();
-
-        // Track ID
-        String songId = item["uri"].as<String>();
-        if (songId.startsWith("spotify:track:"))
-        {
-            songId = songId.substring(14);
-        }
-        currentSong.Id = songId;
+    // Liked state from the cache, a miss is looked up as background work
+    likedPending = false;
+    if (currentSong.Id.length() == 0)
+    {
+        currentSong.isLiked = false;
     }
-    else
+    else if (!lookupLiked(currentSong.Id.c_str(), currentSong.isLiked))
     {
-        currentSong.artist = "Unknown Artist";
-        currentSong.song = "No Song Playing";
-        currentSong.durationMs = 0;
-        currentSong.Id = "";
+        currentSong.isLiked = false;
+        likedPending = true;
     }
 
     // -------- PLAYBACK STATE --------
@@ -285,8 +407,16 @@ bool SpotConn::getTrackInfo()
             ? doc["is_playing"].as<bool>()
             : false;
 
-    lastSongPositionMs = currentSongPositionMs;
+    // A scrub or a seek Spotify has not applied yet wins over the polled position
+    if (!scrubbing && !seekPending && millis() - lastSeekSent > SEEK_SETTLE_TIME)
+    {
+        bool stateChanged = timestamp != stateTimestamp || currentSong.Id != previousId;
+        playbackClock.observe(progressMs, sentMs, receivedMs, isPlaying, stateChanged);
+    }
+    stateTimestamp = timestamp;
+
     success = true;
+    latencyTracer.mark(TRACE_STATE_UPDATE);
 
     if (success)
     {
@@ -296,415 +426,1011 @@ bool SpotConn::getTrackInfo()
     return success;
 }
 
-bool SpotConn::togglePlay()
+// Playback state polled by another controller (see MulticastSync)
+void SpotConn::applySharedState(bool active, bool playing, bool volumeSupported, int sharedVolume, float positionMs, const SongDetails &song)
 {
-    String path = "/v1/me/player/";
-    path += isPlaying ? "pause" : "play";
+    isActive = active;
+    isPlaying = playing;
+    volCtrl = volumeSupported;
+    volume = sharedVolume;
 
-    // Update Screen BEFORE sending request
-    bool oldState = isPlaying;
-    isPlaying = !isPlaying;
-    externalDrawScreen(); // Show change immediately
-
-    String headers =
-        "Authorization: Bearer " + accessToken + "\r\n"
-                                                 "Content-Type: application/json\r\n"
-                                                 "Content-Length: 0\r\n";
-
-    String response;
-
-    bool ok = httpsRequest(
-        "api.spotify.com",
-        path.c_str(),
-        "PUT",
-        headers,
-        "",
-        response);
-
-    if (ok)
+    // Same settle rule as a local poll
+    if (!volumePending && millis() - lastVolumeChange > VOLUME_SETTLE_TIME)
     {
-        isPlaying = !isPlaying;
-        Serial.println(isPlaying ? "Now playing" : "Now paused");
+        currVol = volume;
     }
-    else
+
+    if (!scrubbing && !seekPending && millis() - lastSeekSent > SEEK_SETTLE_TIME)
     {
-        Serial.println("Error toggling playback");
-        isPlaying = oldState;
+        playbackClock.reset(positionMs, millis(), playing);
     }
-
-    return ok;
+    currentSong = song;
+    lastTrackInfoTime = millis();
+    latencyTracer.mark(TRACE_STATE_UPDATE);
+    externalDrawScreen();
 }
 
-bool SpotConn::adjustVolume(int vol)
+bool SpotConn::togglePlay()
 {
-    vol = constrain(vol, 0, 100);
+    // Update Screen BEFORE sending request
+    bool oldState = isPlaying;
+    isPlaying = !isPlaying;
+    playbackClock.setPlaying(isPlaying, millis());
+    latencyTracer.mark(TRACE_STATE_UPDATE);
+    externalDrawScreen(); // Show change immediately
 
-    String path =
-        "/v1/me/player/volume?volume_percent=" + String(vol);
+    return sendCommand(oldState ? CMD_PAUSE : CMD_PLAY, 0);
+}
 
-    String headers =
-        "Authorization: Bearer " + accessToken + "\r\n"
-                                                 "Content-Type: application/json\r\n"
-                                                 "Content-Length: 0\r\n";
+bool SpotConn::adjustVolume(int vol)
+{
+    return sendCommand(CMD_VOLUME, constrain(vol, 0, 100));
+}
 
-    String response;
+// Record the latest wanted volume; serviceVolume() streams it out
+void SpotConn::setVolumeTarget(int vol)
+{
+    volumeTarget = constrain(vol, 0, 100);
+    currVol = volumeTarget;
+    volumePending = true;
+    latencyTracer.mark(TRACE_STATE_UPDATE);
+    lastVolumeChange = millis();
+}
 
-    bool ok = httpsRequest(
-        "api.spotify.com",
-        path.c_str(),
-        "PUT",
-        headers,
-        "",
-        response);
+// Send the latest volume target, at most one request per VOLUME_SEND_INTERVAL.
+// Intermediate values are dropped, the newest target always wins.
+bool SpotConn::volumeDue()
+{
+    return volumePending && millis() - lastVolumeSent >= VOLUME_SEND_INTERVAL;
+}
 
-    if (ok)
-    {
-        currVol = vol;
-        Serial.println("Volume set to: " + String(vol));
-    }
-    else
+bool SpotConn::serviceVolume()
+{
+    if (!volumeDue())
     {
-        Serial.println("Error setting volume");
+        return true;
     }
 
-    getTrackInfo();
-    return ok;
+    int target = volumeTarget;
+    volumePending = false;
+    lastVolumeSent = millis();
+
+    return adjustVolume(target);
 }
 
-bool SpotConn::skipForward()
+// Move the local scrub position; nothing is sent until serviceSeek()
+void SpotConn::scrubBy(long deltaMs)
 {
-    String headers =
-        "Authorization: Bearer " + accessToken + "\r\n"
-                                                 "Content-Type: application/json\r\n"
-                                                 "Content-Length: 0\r\n";
-
-    String response;
-
-    bool ok = httpsRequest(
-        "api.spotify.com",
-        "/v1/me/player/next",
-        "POST",
-        headers,
-        "",
-        response);
-
-    if (ok)
+    if (!scrubbing)
     {
-        Serial.println("Skipped to next track");
-        getTrackInfo();
+        scrubbing = true;
+        scrubPositionMs = getCurrentPositionMs();
+        lastSeekSent = millis(); // A short scrub only sends its end position
     }
-    else
+
+    scrubPositionMs = max(scrubPositionMs + deltaMs, 0.0f);
+    if (currentSong.durationMs > 0)
     {
-        Serial.println("Error skipping forward");
+        scrubPositionMs = min(scrubPositionMs, (float)(currentSong.durationMs - 1));
     }
-
-    return ok;
+    seekTarget = scrubPositionMs;
+    seekPending = true;
 }
 
-bool SpotConn::skipBack()
+// Scrub released, seek to where it ended
+void SpotConn::endScrub()
 {
-    String headers =
-        "Authorization: Bearer " + accessToken + "\r\n"
-                                                 "Content-Type: application/json\r\n"
-                                                 "Content-Length: 0\r\n";
-
-    String response;
-
-    bool ok = httpsRequest(
-        "api.spotify.com",
-        "/v1/me/player/previous",
-        "POST",
-        headers,
-        "",
-        response);
-
-    if (ok)
-    {
-        Serial.println("Skipped to previous track");
-        getTrackInfo();
-    }
-    else
+    if (!scrubbing)
     {
-        Serial.println("Error skipping backward");
+        return;
     }
 
-    return ok;
+    scrubbing = false;
+    seekTo(scrubPositionMs);
 }
 
-bool SpotConn::getStatus()
+// Jump the local position now, the request goes out from serviceSeek()
+void SpotConn::seekTo(int positionMs)
 {
-    return isPlaying;
+    if (currentSong.durationMs > 0)
+    {
+        positionMs = min(positionMs, currentSong.durationMs - 1);
+    }
+    seekTarget = max(positionMs, 0);
+    playbackClock.reset(seekTarget, millis(), isPlaying);
+    seekPending = true;
+    externalDrawScreen();
 }
 
-bool SpotConn::getActiveStatus()
+// Send the latest seek target. While scrubbing at most one per
+// SEEK_SEND_INTERVAL, once the scrub ends right away.
+bool SpotConn::seekDue()
 {
-    return isActive;
+    return seekPending && !(scrubbing && millis() - lastSeekSent < SEEK_SEND_INTERVAL);
 }
 
-float SpotConn::getCurrentPositionMs()
+bool SpotConn::serviceSeek()
 {
-    return currentSongPositionMs;
+    if (!seekDue())
+    {
+        return true;
+    }
+
+    int target = seekTarget;
+    seekPending = false;
+    lastSeekSent = millis();
+
+    return sendCommand(CMD_SEEK, target);
 }
 
-int SpotConn::getCurrentVolume()
+bool SpotConn::skipForward()
 {
-    return volume;
+    return sendCommand(CMD_NEXT, 0);
 }
 
-SongDetails SpotConn::getCurrentSong()
+bool SpotConn::skipBack()
 {
-    return currentSong;
+    return sendCommand(CMD_PREV, 0);
 }
 
-void SpotConn::initialize()
+// Player command endpoints
+static const char *commandMethod(CommandType type)
 {
-    // Create SSL Certificate
-    cert = new SSLCert();
-
-    // Now, we use the function createSelfSignedCert to create private key and certificate.
-    int createCertResult = createSelfSignedCert(
-        *cert,
-        KEYSIZE_1024,
-        "CN=myesp32.local,O=FancyCompany,C=DE",
-        "20190101000000",
-        "20300101000000");
+    return (type == CMD_NEXT || type == CMD_PREV) ? "POST" : "PUT";
+}
 
-    // Now check if creating that worked
-    if (createCertResult != 0)
+static String commandPath(CommandType type, int value)
+{
+    switch (type)
     {
-        Serial.printf("Creating certificate failed. Error Code = 0x%02X, check SSLCert.hpp for details", createCertResult);
-        while (true)
-            delay(500);
+    case CMD_PLAY:
+        return "/v1/me/player/play";
+    case CMD_PAUSE:
+        return "/v1/me/player/pause";
+    case CMD_NEXT:
+        return "/v1/me/player/next";
+    case CMD_PREV:
+        return "/v1/me/player/previous";
+    case CMD_SEEK:
+        return "/v1/me/player/seek?position_ms=" + String(value);
+    case CMD_VOLUME:
+    default:
+        return "/v1/me/player/volume?volume_percent=" + String(value);
     }
-    Serial.println("Creating the certificate was successful");
-
-    // Setup Server using new certificate
-    secureServer = new HTTPSServer(cert, 443, 4);
+}
 
-    // Connect to WiFi
-    WiFi.begin(WIFI_SSID, PASSWORD);
-    Serial.print("Connecting to WiFi");
+// Only PUTs that set absolute state are safe to repeat
+static bool commandIdempotent(CommandType type)
+{
+    return type != CMD_NEXT && type != CMD_PREV;
+}
 
-    while (WiFi.status() != WL_CONNECTED)
+// A failed command is worth replaying if Spotify never saw it, repeating it
+// is harmless, or Spotify asked us to come back later
+static bool retryable(bool written, bool idempotent, int statusCode)
+{
+    if (statusCode == 429 || statusCode >= 500)
     {
-        delay(1000);
-        Serial.print(".");
+        return true;
     }
-
-    Serial.println("\nConnected to WiFi");
-
-    // Set up web server
-    ResourceNode *nodeRoot = new ResourceNode("/", "GET", &handleRoot);
-    ResourceNode *nodeCallback = new ResourceNode("/callback", "GET", &handleCallbackPage);
-    ResourceNode *node404 = new ResourceNode("", "GET", &handle404);
-
-    // Register nodes
-    secureServer->registerNode(nodeRoot);
-    secureServer->registerNode(nodeCallback);
-    secureServer->setDefaultNode(node404); // For 404 handling
-
-    // Start HTTPS server
-    Serial.println("Starting HTTPS server...");
-    secureServer->setDefaultHeader("Connection", "close");
-    secureServer->start();
-
-    if (secureServer->isRunning())
+    if (statusCode != 0)
     {
-        Serial.println("HTTPS server ready.");
-        Serial.print("Access via: https://");
-        Serial.println(WiFi.localIP());
+        return false; // Rejected, e.g. no active device
     }
+    return !written || idempotent;
 }
 
-bool SpotConn::ensureConnection(const char *host)
+String SpotConn::commandHeaders()
 {
-    unsigned long currentTime = millis();
-
-    // Check if connection is stale or needs refresh
-    bool needsReconnect = false;
+    return bearerHeader +
+           "Content-Type: application/json\r\n"
+           "Content-Length: 0\r\n";
+}
 
-    if (!secureClient.connected())
+// Send a command now, or queue it for flushCommands() when pipelining
+bool SpotConn::sendCommand(CommandType type, int value)
+{
+    // The leading controller sends it, and its next snapshot shows the result
+    if (multicastSync.forwardCommand(type, value))
     {
-        Serial.println("Connection lost, reconnecting...");
-        needsReconnect = true;
+        return true;
     }
-    else if (currentTime - lastConnectionTime > CONNECTION_TIMEOUT)
+
+    QueuedCommand command = {type, value, millis()};
+
+    // Offline, or older commands still wait: keep the order, the command job
+    // replays the journal
+    if (journalCount > 0 || WiFi.status() != WL_CONNECTED)
     {
-        Serial.println("Connection idle too long, reconnecting...");
-        needsReconnect = true;
+        journalCommand(command);
+        requestScheduler.markDue(REQUEST_COMMAND, command.queuedAt);
+        return true;
     }
-    else if (requestCount >= MAX_REQUESTS_PER_CONNECTION)
+
+    if (pipelineCommands)
     {
-        Serial.println("Max requests reached, reconnecting...");
-        needsReconnect = true;
+        return queueCommand(type, value);
     }
 
-    if (needsReconnect)
-    {
-        secureClient.stop();
-        delay(100);
+    String response;
+    bool ok = httpsSession.request(
+        "api.spotify.com",
+        commandPath(type, value).c_str(),
+        commandMethod(type),
+        commandHeaders(),
+        "",
+        response);
+
+    finishCommand(command, ok, retryable(httpsSession.lastRequestWritten(), commandIdempotent(type), httpsSession.lastStatusCode()));
+    return ok;
+}
 
-        if (!secureClient.connect(host, 443))
+bool SpotConn::queueCommand(CommandType type, int value)
+{
+    // Latest volume or seek position wins, no need to send the stale one
+    if (type == CMD_VOLUME || type == CMD_SEEK)
+    {
+        for (int i = 0; i < commandCount; i++)
         {
-            Serial.println("Connection failed");
-            return false;
+            if (commandQueue[i].type == type)
+            {
+                commandQueue[i].value = value;
+                return true;
+            }
         }
-
-        Serial.println("Connected to " + String(host));
-        requestCount = 0;
     }
 
-    lastConnectionTime = currentTime;
-    requestCount++;
-    return true;
-}
-
-void SpotConn::closeConnection()
-{
-    if (secureClient.connected())
+    if (commandCount >= MAX_QUEUED_COMMANDS)
     {
-        secureClient.stop();
-        Serial.println("Connection closed");
+        Serial.println("Command queue full, dropping command");
+        finishCommand({type, value, millis()}, false, false);
+        return false;
     }
-    requestCount = 0;
+
+    commandQueue[commandCount++] = {type, value, millis()};
+    return true;
 }
 
-// HTTPS Request Helper Function
-bool httpsRequest(
-    const char *host,
-    const char *path,
-    const String &method,
-    const String &headers,
-    const String &body,
-    String &responseBody)
+// Write all queued commands (and a state refresh) back-to-back on the
+// keep-alive connection, then match the responses in order
+bool SpotConn::flushCommands()
 {
-    // Use the persistent connection from spotifyConnection
-    if (!spotifyConnection.ensureConnection(host))
+    if (commandCount == 0)
     {
-        Serial.println("Failed to ensure connection");
-        return false;
+        return true;
     }
 
-    WiFiClientSecure &client = spotifyConnection.secureClient;
+    QueuedCommand commands[MAX_QUEUED_COMMANDS];
+    int queued = commandCount;
+    memcpy(commands, commandQueue, sizeof(QueuedCommand) * queued);
+    commandCount = 0;
 
-    // ---- Request line ----
-    client.print(method + " " + path + " HTTP/1.1\r\n");
-    client.print("Host: " + String(host) + "\r\n");
-    client.print("User-Agent: ESP32\r\n");
-    client.print("Connection: keep-alive\r\n"); // Changed from "close"
+    PipelineRequest requests[MAX_QUEUED_COMMANDS + 1];
+    String headers = commandHeaders();
+    bool withState = trackInfoPending;
 
-    // ---- Custom headers ----
-    client.print(headers);
+    for (int i = 0; i < queued; i++)
+    {
+        requests[i].method = commandMethod(commands[i].type);
+        requests[i].path = commandPath(commands[i].type, commands[i].value);
+        requests[i].headers = headers;
+        requests[i].idempotent = commandIdempotent(commands[i].type);
+        withState |= commands[i].type == CMD_NEXT || commands[i].type == CMD_PREV;
+    }
 
-    // ---- Content-Length if body exists ----
-    if (body.length() > 0)
+    // The state refresh rides along instead of costing another round trip
+    int count = queued;
+    if (withState)
     {
-        client.print("Content-Length: ");
-        client.print(body.length());
-        client.print("\r\n");
+        requests[count].method = "GET";
+        requests[count].path = "/v1/me/player";
+        requests[count].headers = bearerHeader;
+        requests[count].idempotent = true;
+        count++;
+        trackInfoPending = false;
+        lastTrackInfoTime = millis();
     }
 
-    client.print("\r\n");
+    bool ok = httpsSession.pipeline("api.spotify.com", requests, count);
 
-    // ---- Body ----
-    if (body.length() > 0)
+    for (int i = 0; i < queued; i++)
     {
-        client.print(body);
+        finishCommand(commands[i], requests[i].completed,
+                      retryable(requests[i].written, requests[i].idempotent, requests[i].statusCode));
     }
 
-    // ---- Read status line ----
-    unsigned long timeout = millis();
-    while (client.available() == 0)
+    if (withState)
     {
-        if (millis() - timeout > 10000)
+        if (requests[queued].completed)
+        {
+            trackInfoPending = false;
+            applyPlayerState(requests[queued].response);
+        }
+        else
         {
-            Serial.println("Request timeout");
-            spotifyConnection.closeConnection(); // Force reconnect on timeout
-            return false;
+            trackInfoPending = true;
         }
-        delay(10);
     }
 
-    // Read and parse status line
-    String statusLine = client.readStringUntil('\n');
+    return ok;
+}
 
-    // ---- Read headers ----
-    int contentLength = -1;
-    bool chunked = false;
+// Shared result handling for sent and pipelined commands
+void SpotConn::finishCommand(const QueuedCommand &command, bool ok, bool retry)
+{
+    CommandType type = command.type;
+    int value = command.value;
 
-    while (client.connected() || client.available())
+    // Spotify is unreachable: keep the optimistic state and replay it later
+    if (!ok && retry && journalCommand(command))
     {
-        String line = client.readStringUntil('\n');
-        if (line == "\r")
-            break;
+        Serial.println("Offline, journaled " + commandPath(type, value));
+        return;
+    }
 
-        // Parse Content-Length
-        if (line.startsWith("Content-Length:"))
+    switch (type)
+    {
+    case CMD_PLAY:
+    case CMD_PAUSE:
+        if (ok)
+        {
+            Serial.println(type == CMD_PLAY ? "Now playing" : "Now paused");
+        }
+        else
         {
-            contentLength = line.substring(15).toInt();
+            Serial.println("Error toggling playback");
+            isPlaying = type == CMD_PAUSE;
+            playbackClock.setPlaying(isPlaying, millis());
+            externalDrawScreen();
         }
-        // Check for chunked encoding
-        if (line.indexOf("Transfer-Encoding: chunked") >= 0)
+        break;
+    case CMD_NEXT:
+    case CMD_PREV:
+        if (ok)
         {
-            chunked = true;
+            Serial.println(type == CMD_NEXT ? "Skipped to next track" : "Skipped to previous track");
+            requestTrackInfo();
         }
+        else
+        {
+            Serial.println(type == CMD_NEXT ? "Error skipping forward" : "Error skipping backward");
+        }
+        break;
+    case CMD_VOLUME:
+        if (ok)
+        {
+            volume = value;
+            Serial.println("Volume set to: " + String(value));
+        }
+        else
+        {
+            Serial.println("Error setting volume");
+        }
+        break;
+    case CMD_SEEK:
+        if (ok)
+        {
+            Serial.println("Seeked to " + String(value) + " ms");
+        }
+        else
+        {
+            // Let the next poll put the real position back
+            Serial.println("Error seeking");
+            lastSeekSent = 0;
+            requestTrackInfo();
+        }
+        break;
     }
+}
 
-    // ---- Read body ----
-    responseBody = "";
+// Does a newer command make an older journaled one pointless?
+static bool supersedes(CommandType newer, CommandType older)
+{
+    switch (newer)
+    {
+    case CMD_PLAY:
+    case CMD_PAUSE:
+        return older == CMD_PLAY || older == CMD_PAUSE;
+    case CMD_VOLUME:
+        return older == CMD_VOLUME;
+    case CMD_SEEK:
+    case CMD_NEXT:
+    case CMD_PREV:
+        return older == CMD_SEEK; // A seek in a track we have skipped away from
+    }
+    return false;
+}
+
+static unsigned long journalTtl(CommandType type)
+{
+    bool momentary = type == CMD_NEXT || type == CMD_PREV || type == CMD_SEEK;
+    return momentary ? SpotConn::JOURNAL_SKIP_TTL : SpotConn::JOURNAL_STATE_TTL;
+}
 
-    if (contentLength == 0)
+// Record a command Spotify did not get. Latest wins: at most one play/pause,
+// one volume and one seek are kept, skips stay in order. Returns false if
+// the command is already too old.
+bool SpotConn::journalCommand(const QueuedCommand &command)
+{
+    unsigned long now = millis();
+    if (now - command.queuedAt > journalTtl(command.type))
     {
-        // No body (e.g., 204 response)
-        return true;
+        return false;
     }
-    else if (contentLength > 0)
+
+    expireJournal(now);
+    int kept = 0;
+    for (int i = 0; i < journalCount; i++)
     {
-        // Read exact content length
-        int totalRead = 0;
-        while (totalRead < contentLength && client.connected())
+        if (!supersedes(command.type, journal[i].type))
         {
-            if (client.available())
-            {
-                char c = client.read();
-                responseBody += c;
-                totalRead++;
-            }
+            journal[kept++] = journal[i];
         }
     }
-    else if (chunked)
+    journalCount = kept;
+
+    if (journalCount >= MAX_JOURNAL)
+    {
+        Serial.println("Journal full, dropping oldest command");
+        memmove(journal, journal + 1, sizeof(QueuedCommand) * --journalCount);
+    }
+
+    journal[journalCount++] = command;
+    return true;
+}
+
+void SpotConn::expireJournal(unsigned long now)
+{
+    int kept = 0;
+    for (int i = 0; i < journalCount; i++)
     {
-        // Handle chunked encoding
-        while (client.connected() || client.available())
+        if (now - journal[i].queuedAt <= journalTtl(journal[i].type))
         {
-            String chunkSizeLine = client.readStringUntil('\n');
-            int chunkSize = strtol(chunkSizeLine.c_str(), NULL, 16);
+            journal[kept++] = journal[i];
+        }
+    }
+    if (kept < journalCount)
+    {
+        Serial.printf("Journal: %d commands expired\n", journalCount - kept);
+    }
+    journalCount = kept;
+}
 
-            if (chunkSize == 0)
-                break; // Last chunk
+// Replay journaled commands in one pipelined round trip with a state
+// refresh, at most once per JOURNAL_RETRY_INTERVAL. Commands that fail
+// again go back into the journal through finishCommand().
+bool SpotConn::journalDue()
+{
+    return journalCount > 0 && millis() - lastJournalReplay >= JOURNAL_RETRY_INTERVAL;
+}
 
-            for (int i = 0; i < chunkSize && client.available(); i++)
-            {
-                responseBody += (char)client.read();
-            }
-            client.readStringUntil('\n');
+bool SpotConn::serviceJournal()
+{
+    unsigned long now = millis();
+    if (!journalDue())
+    {
+        return true;
+    }
+    lastJournalReplay = now;
+
+    expireJournal(now);
+    if (journalCount == 0)
+    {
+        return true;
+    }
+    if (WiFi.status() != WL_CONNECTED)
+    {
+        return false;
+    }
+
+    // Oldest first, ahead of anything queued since
+    int moved = min(journalCount, MAX_QUEUED_COMMANDS - commandCount);
+    memmove(commandQueue + moved, commandQueue, sizeof(QueuedCommand) * commandCount);
+    memcpy(commandQueue, journal, sizeof(QueuedCommand) * moved);
+    commandCount += moved;
+    journalCount -= moved;
+    memmove(journal, journal + moved, sizeof(QueuedCommand) * journalCount);
+
+    Serial.printf("Replaying %d journaled commands\n", moved);
+    requestTrackInfo();
+    return flushCommands();
+}
+
+bool SpotConn::toggleLiked()
+{
+    if (currentSong.Id.length() == 0)
+    {
+        return false;
+    }
+
+    FixedString<23> id = currentSong.Id;
+    bool oldState = currentSong.isLiked;
+
+    // Update Screen BEFORE sending request
+    currentSong.isLiked = !oldState;
+    latencyTracer.mark(TRACE_STATE_UPDATE);
+    externalDrawScreen();
+
+    String headers =
+        bearerHeader +
+        "Content-Type: application/json\r\n"
+        "Content-Length: 0\r\n";
+
+    String path = "/v1/me/tracks?ids=";
+    path += id.c_str();
+    String response;
+
+    bool ok = httpsSession.request(
+        "api.spotify.com",
+        path.c_str(),
+        oldState ? "DELETE" : "PUT",
+        headers,
+        "",
+        response);
+
+    if (ok)
+    {
+        storeLiked(id.c_str(), !oldState);
+        if (currentSong.Id == id)
+        {
+            likedPending = false;
         }
+        Serial.println(oldState ? "Removed from Liked Songs" : "Added to Liked Songs");
     }
     else
     {
-        // No Content-Length header, read until connection closes or timeout
-        timeout = millis();
-        while (client.connected() || client.available())
+        Serial.println("Error toggling liked state");
+        invalidateLiked(id.c_str());
+        if (currentSong.Id == id)
         {
-            if (client.available())
+            currentSong.isLiked = oldState;
+            externalDrawScreen();
+        }
+    }
+
+    return ok;
+}
+
+bool SpotConn::lookupLiked(const char *id, bool &liked)
+{
+    if (id == nullptr || id[0] == '\0')
+    {
+        return false;
+    }
+
+    for (int i = 0; i < LIKED_CACHE_SIZE; i++)
+    {
+        if (strcmp(likedCache[i].id, id) == 0)
+        {
+            liked = likedCache[i].liked;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SpotConn::storeLiked(const char *id, bool liked)
+{
+    if (id == nullptr || id[0] == '\0' || strlen(id) >= sizeof(likedCache[0].id))
+    {
+        return;
+    }
+
+    for (int i = 0; i < LIKED_CACHE_SIZE; i++)
+    {
+        if (strcmp(likedCache[i].id, id) == 0)
+        {
+            likedCache[i].liked = liked;
+            return;
+        }
+    }
+
+    // Not cached yet, replace the oldest entry
+    LikedCacheEntry &entry = likedCache[likedCacheNext];
+    strlcpy(entry.id, id, sizeof(entry.id));
+    entry.liked = liked;
+    likedCacheNext = (likedCacheNext + 1) % LIKED_CACHE_SIZE;
+}
+
+void SpotConn::invalidateLiked(const char *id)
+{
+    for (int i = 0; i < LIKED_CACHE_SIZE; i++)
+    {
+        if (strcmp(likedCache[i].id, id) == 0)
+        {
+            likedCache[i].id[0] = '\0';
+        }
+    }
+}
+
+// Look up the liked state of the current track and the upcoming queue in one
+// /me/tracks/contains call, so following tracks are already cached.
+bool SpotConn::fetchLikedStates()
+{
+    FixedString<23> ids[LIKED_BATCH_SIZE];
+    int idCount = 0;
+    bool dummy;
+
+    if (currentSong.Id.length() == 0)
+    {
+        return false;
+    }
+    ids[idCount++] = currentSong.Id;
+
+    String response;
+
+    // -------- QUEUE PREFETCH --------
+    bool ok = httpsSession.request(
+        "api.spotify.com",
+        "/v1/me/player/queue",
+        "GET",
+        bearerHeader,
+        "",
+        response);
+
+    if (ok && response.length() > 0)
+    {
+        JsonPoolLease queueLease(queuePool);
+        JsonDocument &queueDoc = queueLease.doc();
+        DeserializationError error = deserializeJson(queueDoc, response, DeserializationOption::Filter(queueFilter()));
+        if (!error)
+        {
+            for (JsonObject track : queueDoc["queue"].as<JsonArray>())
             {
-                responseBody += client.readString();
-                timeout = millis();
+                if (idCount >= LIKED_BATCH_SIZE)
+                    break;
+
+                // Episodes in the queue would fail the whole contains call
+                const char *id = track["id"].as<const char *>();
+                if (id == nullptr || track["type"] != "track" || lookupLiked(id, dummy))
+                    continue;
+
+                bool duplicate = false;
+                for (int i = 0; i < idCount; i++)
+                {
+                    if (ids[i] == id)
+                    {
+                        duplicate = true;
+                        break;
+                    }
+                }
+                if (!duplicate)
+                {
+                    ids[idCount++] = id;
+                }
             }
-            if (millis() - timeout > 2000)
-                break; // 2 second timeout for remaining data
         }
     }
 
+    // -------- CONTAINS LOOKUP --------
+    String path = "/v1/me/tracks/contains?ids=";
+    for (int i = 0; i < idCount; i++)
+    {
+        if (i > 0)
+            path += ",";
+        path += ids[i].c_str();
+    }
+
+    response = "";
+    ok = httpsSession.request(
+        "api.spotify.com",
+        path.c_str(),
+        "GET",
+        bearerHeader,
+        "",
+        response);
+
+    if (!ok)
+    {
+        Serial.println("HTTPS liked lookup failed");
+        return false;
+    }
+
+    JsonPoolLease lease(likedPool);
+    JsonDocument &doc = lease.doc();
+    DeserializationError error = deserializeJson(doc, response);
+    if (error || !doc.is<JsonArray>())
+    {
+        Serial.println("Liked lookup returned unexpected response");
+        return false;
+    }
+
+    JsonArray results = doc.as<JsonArray>();
+    for (int i = 0; i < idCount && i < (int)results.size(); i++)
+    {
+        storeLiked(ids[i].c_str(), results[i].as<bool>());
+    }
+
+    Serial.println("Cached liked state for " + String(idCount) + " tracks");
     return true;
-}
\ No newline at end of file
+}
+
+// The current track's liked state is missing, and its last lookup did not just fail
+bool SpotConn::likedDue()
+{
+    if (!likedPending || currentSong.Id.length() == 0)
+    {
+        return false;
+    }
+    return currentSong.Id != likedFailedId || millis() - likedFailedAt > LIKED_RETRY_INTERVAL;
+}
+
+// Fetch the liked state likedDue() asked for; true if the screen changed
+bool SpotConn::serviceLiked()
+{
+    FixedString<23> id = currentSong.Id;
+
+    if (!fetchLikedStates())
+    {
+        // A lookup that gave way to input is retried right away
+        if (!requestScheduler.aborted())
+        {
+            likedFailedId = id;
+            likedFailedAt = millis();
+        }
+        return false;
+    }
+
+    // The track may have changed while the lookup ran, the new one has its own
+    if (currentSong.Id != id)
+    {
+        return false;
+    }
+
+    bool liked;
+    if (!lookupLiked(id.c_str(), liked))
+    {
+        likedFailedId = id;
+        likedFailedAt = millis();
+        return false;
+    }
+    likedPending = false;
+    currentSong.isLiked = liked;
+    return true;
+}
+
+// Start a playlist (or album) at the given track position
+bool SpotConn::playContext(const char *contextUri, int position)
+{
+    String body = "{\"context_uri\":\"" + String(contextUri) + "\",\"offset\":{\"position\":" + String(position) + "}}";
+
+    String headers =
+        bearerHeader +
+        "Content-Type: application/json\r\n";
+
+    String response;
+
+    bool ok = httpsSession.request(
+        "api.spotify.com",
+        "/v1/me/player/play",
+        "PUT",
+        headers,
+        body,
+        response);
+
+    if (!ok)
+    {
+        Serial.println("Error starting playback");
+        return false;
+    }
+
+    Serial.println("Playing " + String(contextUri) + " from track " + String(position));
+    isPlaying = true;
+    requestTrackInfo();
+    return true;
+}
+
+// -------- DEVICES --------
+bool SpotConn::fetchDevices()
+{
+    // Failures also wait out the TTL instead of retrying every loop
+    devicesFetchedAt = millis();
+
+    String response;
+
+    bool ok = httpsSession.request(
+        "api.spotify.com",
+        "/v1/me/player/devices",
+        "GET",
+        bearerHeader,
+        "",
+        response);
+
+    if (!ok)
+    {
+        Serial.println("HTTPS device list failed");
+        return false;
+    }
+
+    JsonPoolLease lease(devicesPool);
+    JsonDocument &doc = lease.doc();
+    DeserializationError error = deserializeJson(doc, response, DeserializationOption::Filter(devicesFilter()));
+    if (error)
+    {
+        Serial.print("JSON parsing failed: ");
+        Serial.println(error.c_str());
+        return false;
+    }
+
+    deviceCount = 0;
+    for (JsonObject device : doc["devices"].as<JsonArray>())
+    {
+        if (deviceCount >= MAX_DEVICES)
+            break;
+
+        const char *id = device["id"].as<const char *>();
+        if (id == nullptr)
+            continue; // Devices without an ID cannot be targeted
+
+        DeviceInfo &info = devices[deviceCount++];
+        info.id = id;
+        info.name = device["name"].as<const char *>();
+        info.type = device["type"].as<const char *>();
+        info.isActive = device["is_active"].as<bool>();
+        info.isRestricted = device["is_restricted"].as<bool>();
+    }
+
+    Serial.println("Found " + String(deviceCount) + " devices");
+    return true;
+}
+
+bool SpotConn::devicesStale()
+{
+    return devicesFetchedAt == 0 || millis() - devicesFetchedAt > DEVICE_LIST_TTL;
+}
+
+// Move playback to another device and start playing there
+bool SpotConn::transferPlayback(const char *deviceId)
+{
+    String body = "{\"device_ids\":[\"" + String(deviceId) + "\"],\"play\":true}";
+
+    String headers =
+        bearerHeader +
+        "Content-Type: application/json\r\n";
+
+    String response;
+
+    bool ok = httpsSession.request(
+        "api.spotify.com",
+        "/v1/me/player",
+        "PUT",
+        headers,
+        body,
+        response);
+
+    if (!ok)
+    {
+        Serial.println("Error transferring playback");
+        return false;
+    }
+
+    // The new device takes a moment to report in, poll fast until it does
+    Serial.println("Playback transferred to " + String(deviceId));
+    fastPollUntil = millis() + FAST_POLL_WINDOW;
+    devicesFetchedAt = 0;
+    requestTrackInfo();
+    return true;
+}
+
+unsigned long SpotConn::trackInfoInterval()
+{
+    if (!isPlaying && (long)(fastPollUntil - millis()) > 0)
+    {
+        return FAST_POLL_INTERVAL;
+    }
+    return isPlaying ? API_REFRESH_INTERVAL : 30000; // 30s when paused
+}
+
+bool SpotConn::getStatus()
+{
+    return isPlaying;
+}
+
+bool SpotConn::getActiveStatus()
+{
+    return isActive;
+}
+
+float SpotConn::getCurrentPositionMs()
+{
+    return scrubbing ? scrubPositionMs : playbackClock.positionAt(millis());
+}
+
+int SpotConn::getCurrentVolume()
+{
+    return volume;
+}
+
+const SongDetails &SpotConn::getCurrentSong()
+{
+    return currentSong;
+}
+
+const String &SpotConn::getAuthHeader()
+{
+    return bearerHeader;
+}
+
+void SpotConn::initialize()
+{
+    // Create SSL Certificate
+    cert = new SSLCert();
+
+    // Now, we use the function createSelfSignedCert to create private key and certificate.
+    int createCertResult = createSelfSignedCert(
+        *cert,
+        KEYSIZE_1024,
+        "CN=myesp32.local,O=FancyCompany,C=DE",
+        "20190101000000",
+        "20300101000000");
+
+    // Now check if creating that worked
+    if (createCertResult != 0)
+    {
+        Serial.printf("Creating certificate failed. Error Code = 0x%02X, check SSLCert.hpp for details", createCertResult);
+        while (true)
+            delay(500);
+    }
+    Serial.println("Creating the certificate was successful");
+
+    // Setup Server using new certificate
+    secureServer = new HTTPSServer(cert, 443, 4);
+
+    // Connect to WiFi
+    WiFi.begin(WIFI_SSID, PASSWORD);
+    Serial.print("Connecting to WiFi");
+
+    while (WiFi.status() != WL_CONNECTED)
+    {
+        delay(1000);
+        Serial.print(".");
+    }
+
+    Serial.println("\nConnected to WiFi");
+
+    // Set up web server
+    ResourceNode *nodeRoot = new ResourceNode("/", "GET", &handleRoot);
+    ResourceNode *nodeCallback = new ResourceNode("/callback", "GET", &handleCallbackPage);
+    ResourceNode *node404 = new ResourceNode("", "GET", &handle404);
+
+    // Register nodes
+    secureServer->registerNode(nodeRoot);
+    secureServer->registerNode(nodeCallback);
+    secureServer->setDefaultNode(node404); // For 404 handling
+
+    // Start HTTPS server
+    Serial.println("Starting HTTPS server...");
+    // No "Connection: close" default, LAN API clients reuse their TLS sessions
+    secureServer->start();
+
+    if (secureServer->isRunning())
+    {
+        Serial.println("HTTPS server ready.");
+        Serial.print("Access via: https://");
+        Serial.println(WiFi.localIP());
+    }
+}
+
+// Resolve through the DNS cache and open TLS by address; the host name
+// still goes out for SNI and certificate checks
+static bool connectSpotify(const char *host)
+{
+    IPAddress ip;
+    if (!dnsCache.resolve(host, ip))
+    {
+        Serial.println("Connection failed: cannot resolve " + String(host));
+        return false;
+    }
+    unsigned long dnsMs = dnsCache.lastResolveMs();
+
+    unsigned long tlsStart = millis();
+    if (!secureClient.connect(ip, 443, host, spotify_root_ca, nullptr, nullptr))
+    {
+        Serial.println("Connection failed");
+        dnsCache.invalidate(host);
+        return false;
+    }
+
+    Serial.printf("Connected to %s (dns %lu ms, tls %lu ms)\n", host, dnsMs, millis() - tlsStart);
+    return true;
+}
@@ -23,10 +23,18 @@
 #include <HTTPResponse.hpp>
 
 #include "secrets.h"
-#include "index.h"
+#include "fixedString.h"
+#include "songDetails.h"
+#include "playbackClock.h"
+#include "httpsSession.h"
 
 using namespace httpsserver;
 
+// Send queued player commands back-to-back on the keep-alive connection
+#ifndef PIPELINE_COMMANDS
+#define PIPELINE_COMMANDS true
+#endif
+
 // Forward declarations
 void handle404(HTTPRequest *req, HTTPResponse *res);
 void handleRoot(HTTPRequest *req, HTTPResponse *res);
@@ -36,24 +44,39 @@ void setDrawScreenCallback(void (*callback)());
 // Spotify Root CA Certificate (extern declaration)
 extern const char *spotify_root_ca;
 
-// HTTPS Request Helper Function
-bool httpsRequest(
-    const char *host,
-    const char *path,
-    const String &method,
-    const String &headers,
-    const String &body,
-    String &responseBody);
-
-// Song details struct
-struct SongDetails
+// Player commands that can be pipelined
+enum CommandType : uint8_t
+{
+    CMD_PLAY,
+    CMD_PAUSE,
+    CMD_NEXT,
+    CMD_PREV,
+    CMD_VOLUME,
+    CMD_SEEK
+};
+
+struct QueuedCommand
+{
+    CommandType type;
+    int value;
+    unsigned long queuedAt; // millis() of the input, for journal expiry
+};
+
+// Liked-state cache entry (Spotify track IDs are 22 characters)
+struct LikedCacheEntry
 {
-    int durationMs;
-    String album;
-    String artist;
-    String song;
-    String Id;
-    bool isLiked;
+    char id[23];
+    bool liked;
+};
+
+// Playback device from /me/player/devices (device IDs are 40 characters)
+struct DeviceInfo
+{
+    FixedString<41> id;
+    FixedString<48> name;
+    FixedString<16> type;
+    bool isActive;
+    bool isRestricted;
 };
 
 // Spotify Connection Class
@@ -61,53 +84,135 @@ class SpotConn
 {
 public:
     SpotConn();
-    WiFiClientSecure secureClient;
 
     // Authentication methods
     bool getUserCode(const String &serverCode);
     bool refreshAuth();
+    bool refreshDue();
 
     // Player control methods
     bool getTrackInfo();
+    bool applyPlayerState(const String &response);
+    void applySharedState(bool active, bool playing, bool volumeSupported, int sharedVolume, float positionMs, const SongDetails &song);
+    void requestTrackInfo();
+    bool serviceTrackInfo();
+    bool commandsDue();
+    void serviceCommands();
     bool togglePlay();
     bool adjustVolume(int vol);
+    void setVolumeTarget(int vol);
+    bool volumeDue();
+    bool serviceVolume();
+    void scrubBy(long deltaMs);
+    void endScrub();
+    void seekTo(int positionMs);
+    bool seekDue();
+    bool serviceSeek();
     bool skipForward();
     bool skipBack();
+    bool toggleLiked();
+    bool playContext(const char *contextUri, int position);
+
+    // Command queue
+    bool sendCommand(CommandType type, int value);
+    bool queueCommand(CommandType type, int value);
+    bool flushCommands();
+    void finishCommand(const QueuedCommand &command, bool ok, bool retry);
+
+    // Offline journal
+    bool journalCommand(const QueuedCommand &command);
+    void expireJournal(unsigned long now);
+    bool journalDue();
+    bool serviceJournal();
+    String commandHeaders();
+
+    // Device picker
+    bool fetchDevices();
+    bool devicesStale();
+    bool transferPlayback(const char *deviceId);
+    unsigned long trackInfoInterval();
 
     // Status getters
     bool getStatus();
     bool getActiveStatus();
     float getCurrentPositionMs();
     int getCurrentVolume();
-    SongDetails getCurrentSong();
+    const SongDetails &getCurrentSong();
+    const String &getAuthHeader();
+
+    // Liked-state cache
+    bool lookupLiked(const char *id, bool &liked);
+    void storeLiked(const char *id, bool liked);
+    void invalidateLiked(const char *id);
+    bool fetchLikedStates();
+    bool likedDue();
+    bool serviceLiked();
 
     // Initialization
     void initialize();
 
-    // WifiClient Secure Methods
-    bool ensureConnection(const char *host);
-    void closeConnection();
-
     // Public member variables
     bool accessTokenSet;
     unsigned long tokenStartTime;
     int tokenExpireTime;
     SongDetails currentSong;
-    float currentSongPositionMs;
-    float lastSongPositionMs;
+    PlaybackClock playbackClock;
+    uint64_t stateTimestamp; // Spotify's "timestamp", changes with the playback state
     int currVol;
     bool isPlaying;
     bool isActive;
     bool volCtrl;
     int volume;
-    unsigned long lastConnectionTime;
-    unsigned int requestCount;
-    static const unsigned long CONNECTION_TIMEOUT = 60000;      // 60 seconds idle timeout
-    static const unsigned int MAX_REQUESTS_PER_CONNECTION = 50; // Reconnect after N requests
+    unsigned long lastRefreshAttempt;
+    unsigned long lastTrackInfoTime;
+    bool trackInfoPending;
+    unsigned long avoidedTrackInfoRequests;
+    int volumeTarget;
+    bool volumePending;
+    unsigned long lastVolumeSent;
+    unsigned long lastVolumeChange;
+    bool scrubbing;
+    float scrubPositionMs; // Shown instead of the playback position while scrubbing
+    int seekTarget;
+    bool seekPending;
+    unsigned long lastSeekSent;
+    static const int MAX_QUEUED_COMMANDS = 8;
+    QueuedCommand commandQueue[MAX_QUEUED_COMMANDS];
+    int commandCount;
+    bool pipelineCommands;
+    static const int MAX_JOURNAL = 8;
+    QueuedCommand journal[MAX_JOURNAL]; // Commands Spotify never got, oldest first
+    int journalCount;
+    unsigned long lastJournalReplay;
+    static const int MAX_DEVICES = 8;
+    DeviceInfo devices[MAX_DEVICES];
+    int deviceCount;
+    unsigned long devicesFetchedAt;
+    unsigned long fastPollUntil;
+    bool likedPending;               // Current track's liked state is not cached yet
+    FixedString<23> likedFailedId;   // Last track whose lookup failed, not retried before LIKED_RETRY_INTERVAL
+    unsigned long likedFailedAt;
+    static const unsigned long TOKEN_RETRY_INTERVAL = 10000;    // Between failed token refreshes
+    static const unsigned long VOLUME_SEND_INTERVAL = 200;      // Min time between streamed volume updates
+    static const unsigned long VOLUME_SETTLE_TIME = 2000;       // Ignore polled volume this long after a change
+    static const unsigned long SEEK_SEND_INTERVAL = 1000;       // Min time between seeks during a long scrub
+    static const unsigned long SEEK_SETTLE_TIME = 1500;         // Ignore polled progress this long after a seek
+    static const int LIKED_BATCH_SIZE = 50;                     // Max IDs per /me/tracks/contains call
+    static const int LIKED_CACHE_SIZE = 64;
+    static const unsigned long LIKED_RETRY_INTERVAL = 60000;    // Between lookups for a track that failed
+    static const unsigned long DEVICE_LIST_TTL = 15000;         // Device list is refetched when older than this
+    static const unsigned long FAST_POLL_INTERVAL = 1000;       // Poll rate while waiting for a transfer to land
+    static const unsigned long FAST_POLL_WINDOW = 10000;        // How long a transfer keeps the fast poll going
+    static const unsigned long JOURNAL_RETRY_INTERVAL = 5000;   // Between replay attempts while offline
+    static const unsigned long JOURNAL_SKIP_TTL = 30000;        // Skips and seeks older than this are dropped
+    static const unsigned long JOURNAL_STATE_TTL = 300000;      // Play/pause and volume last longer
 
 private:
     String accessToken;
     String refreshToken;
+    String bearerHeader; // "Authorization: Bearer ..." line, rebuilt when the token changes
+    LikedCacheEntry likedCache[LIKED_CACHE_SIZE];
+    int likedCacheNext;
 };
 
 // Global instances (extern declarations)
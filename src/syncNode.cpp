@@ -0,0 +1,294 @@
+#include "syncNode.h"
+
+SyncNode::SyncNode(SyncLink &link, SyncPlayer &player) : link(link),
+                                                         player(player),
+                                                         nodeId(0),
+                                                         leaderId(0),
+                                                         sequence(0),
+                                                         lastStateSequence(0),
+                                                         stateSequenceKnown(false),
+                                                         peerCount(0),
+                                                         pendingCount(0),
+                                                         nextCommandId(0),
+                                                         handledNext(0),
+                                                         lastSent(0),
+                                                         lastPublishedPoll(0),
+                                                         stats()
+{
+    memset(handled, 0, sizeof(handled));
+}
+
+void SyncNode::begin(uint32_t id, uint32_t firstCommandId)
+{
+    nodeId = id;
+    leaderId = id;
+    nextCommandId = firstCommandId;
+}
+
+void SyncNode::service()
+{
+    receive();
+    elect();
+    retryPending();
+
+    unsigned long now = millis();
+    if (!following())
+    {
+        // A fresh poll goes out right away, otherwise the state doubles as heartbeat
+        unsigned long lastPoll = player.lastPollTime();
+        if (lastPoll != lastPublishedPoll || now - lastSent >= HEARTBEAT_INTERVAL)
+        {
+            uint8_t body[MAX_PACKET - sizeof(SyncHeader)];
+            size_t length = player.encodeState(body, sizeof(body));
+            if (length > 0)
+            {
+                send(SYNC_STATE, body, length);
+            }
+            lastPublishedPoll = lastPoll;
+        }
+    }
+    else if (now - lastSent >= HEARTBEAT_INTERVAL)
+    {
+        send(SYNC_HEARTBEAT, nullptr, 0);
+    }
+}
+
+bool SyncNode::forwardCommand(uint8_t type, int32_t value)
+{
+    // A full table means the leader stopped acking, send it ourselves
+    if (!following() || pendingCount >= MAX_PENDING)
+    {
+        return false;
+    }
+
+    PendingCommand &command = pending[pendingCount++];
+    command.commandId = ++nextCommandId;
+    command.type = type;
+    command.value = value;
+    command.queuedAt = millis();
+    command.attempts = 0;
+    sendPending(command);
+    return true;
+}
+
+void SyncNode::sendPending(PendingCommand &command)
+{
+    // Addressed to the current leader, which may have changed since the first try
+    SyncCommand packet = {leaderId, command.commandId, command.type, command.value};
+    uint8_t body[16];
+    size_t length = encodeSyncCommand(body, sizeof(body), packet);
+    send(SYNC_COMMAND, body, length);
+
+    command.sentAt = millis();
+    command.attempts++;
+}
+
+// Resend unacked commands; after the last attempt (or once this node leads)
+// they go to the journal, which sends them to Spotify directly
+void SyncNode::retryPending()
+{
+    unsigned long now = millis();
+    int kept = 0;
+
+    for (int i = 0; i < pendingCount; i++)
+    {
+        PendingCommand &command = pending[i];
+        if (following() && now - command.sentAt < ACK_TIMEOUT)
+        {
+            pending[kept++] = command;
+            continue;
+        }
+        if (following() && command.attempts < MAX_ATTEMPTS)
+        {
+            sendPending(command);
+            stats.commandRetries++;
+            pending[kept++] = command;
+            continue;
+        }
+
+        Serial.printf("Multicast sync: command %u not acked, sending it directly\n", command.type);
+        player.journalCommand(command.type, command.value, command.queuedAt);
+        stats.commandFallbacks++;
+    }
+    pendingCount = kept;
+}
+
+void SyncNode::receive()
+{
+    uint8_t buffer[MAX_PACKET];
+    size_t length;
+    while ((length = link.receive(buffer, sizeof(buffer))) > 0)
+    {
+        if (length >= sizeof(SyncHeader))
+        {
+            handlePacket(buffer, length);
+        }
+    }
+}
+
+void SyncNode::handlePacket(const uint8_t *buffer, size_t length)
+{
+    SyncHeader packet;
+    memcpy(&packet, buffer, sizeof(packet));
+    if (packet.magic != MAGIC || packet.version != VERSION || packet.nodeId == nodeId)
+    {
+        return; // Foreign traffic or our own packet looped back
+    }
+    stats.packetsIn++;
+
+    // Any packet proves the sender is alive
+    unsigned long now = millis();
+    int slot = -1;
+    for (int i = 0; i < peerCount; i++)
+    {
+        if (peers[i].id == packet.nodeId)
+        {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0 && peerCount < MAX_PEERS)
+    {
+        slot = peerCount++;
+        peers[slot].id = packet.nodeId;
+        Serial.printf("Multicast sync: node %08x joined\n", packet.nodeId);
+    }
+    if (slot >= 0)
+    {
+        peers[slot].lastSeen = now;
+    }
+
+    switch (packet.type)
+    {
+    case SYNC_STATE:
+        // Only the leader's snapshots count, and only newer ones
+        elect();
+        if (packet.nodeId != leaderId || (stateSequenceKnown && !syncSequenceNewer(packet.sequence, lastStateSequence)))
+            break;
+        lastStateSequence = packet.sequence;
+        stateSequenceKnown = true;
+        player.applyState(buffer + sizeof(SyncHeader), length - sizeof(SyncHeader));
+        break;
+    case SYNC_COMMAND:
+        handleCommand(packet.nodeId, buffer + sizeof(SyncHeader), length - sizeof(SyncHeader));
+        break;
+    case SYNC_ACK:
+        handleAck(buffer + sizeof(SyncHeader), length - sizeof(SyncHeader));
+        break;
+    default:
+        break;
+    }
+}
+
+// Leader: run a forwarded command once, ack every copy of it
+void SyncNode::handleCommand(uint32_t sender, const uint8_t *body, size_t length)
+{
+    SyncCommand command;
+    if (following() || !decodeSyncCommand(body, length, command) || command.target != nodeId)
+    {
+        return;
+    }
+
+    // A lost ack brings the same command again
+    SyncAck ack = {sender, command.commandId};
+    uint8_t ackBody[8];
+    send(SYNC_ACK, ackBody, encodeSyncAck(ackBody, sizeof(ackBody), ack));
+
+    for (int i = 0; i < MAX_HANDLED; i++)
+    {
+        if (handled[i].nodeId == sender && handled[i].commandId == command.commandId)
+        {
+            return;
+        }
+    }
+    handled[handledNext] = {sender, command.commandId};
+    handledNext = (handledNext + 1) % MAX_HANDLED;
+
+    Serial.printf("Multicast sync: command %u from %08x\n", command.type, sender);
+    player.runCommand(command.type, command.value);
+    player.requestTrackInfo();
+}
+
+// Follower: the leader has the command, stop resending it
+void SyncNode::handleAck(const uint8_t *body, size_t length)
+{
+    SyncAck ack;
+    if (!decodeSyncAck(body, length, ack) || ack.target != nodeId)
+    {
+        return;
+    }
+
+    for (int i = 0; i < pendingCount; i++)
+    {
+        if (pending[i].commandId == ack.commandId)
+        {
+            pendingCount--;
+            memmove(pending + i, pending + i + 1, sizeof(PendingCommand) * (pendingCount - i));
+            return;
+        }
+    }
+}
+
+// The live node with the lowest ID leads
+void SyncNode::elect()
+{
+    unsigned long now = millis();
+    uint32_t lowest = nodeId;
+
+    for (int i = 0; i < peerCount;)
+    {
+        if (now - peers[i].lastSeen > PEER_TIMEOUT)
+        {
+            Serial.printf("Multicast sync: node %08x gone\n", peers[i].id);
+            peers[i] = peers[--peerCount];
+            continue;
+        }
+        lowest = min(lowest, peers[i].id);
+        i++;
+    }
+
+    if (lowest == leaderId)
+    {
+        return;
+    }
+
+    leaderId = lowest;
+    stateSequenceKnown = false;
+    if (leaderId == nodeId)
+    {
+        // Take over polling straight away
+        Serial.println("Multicast sync: now leading");
+        player.requestTrackInfo();
+    }
+    else
+    {
+        Serial.printf("Multicast sync: following %08x\n", leaderId);
+    }
+}
+
+SyncHeader SyncNode::header(SyncPacketType type)
+{
+    SyncHeader packet;
+    packet.magic = MAGIC;
+    packet.version = VERSION;
+    packet.type = type;
+    packet.nodeId = nodeId;
+    packet.sequence = ++sequence;
+    return packet;
+}
+
+void SyncNode::send(SyncPacketType type, const uint8_t *body, size_t bodyLength)
+{
+    SyncHeader packet = header(type);
+    link.send((const uint8_t *)&packet, sizeof(packet), body, bodyLength);
+
+    lastSent = millis();
+    stats.packetsOut++;
+}
+
+SyncStats SyncNode::takeSyncStats()
+{
+    SyncStats taken = stats;
+    stats = SyncStats();
+    return taken;
+}
@@ -0,0 +1,136 @@
+#ifndef SYNCNODE_H
+#define SYNCNODE_H
+
+#include <Arduino.h>
+#include "syncPacket.h"
+
+// Datagram transport of the sync group (UDP multicast on the device)
+class SyncLink
+{
+public:
+    virtual ~SyncLink() {}
+
+    // Copy the next waiting packet into buffer; its length, 0 when none waits
+    virtual size_t receive(uint8_t *buffer, size_t size) = 0;
+    virtual void send(const uint8_t *header, size_t headerLength, const uint8_t *body, size_t bodyLength) = 0;
+};
+
+// The local player a node shares and steers (SpotConn on the device)
+class SyncPlayer
+{
+public:
+    virtual ~SyncPlayer() {}
+
+    virtual size_t encodeState(uint8_t *buffer, size_t size) = 0;
+    virtual bool applyState(const uint8_t *buffer, size_t length) = 0;
+    // Leader: run a command a follower forwarded
+    virtual void runCommand(uint8_t type, int32_t value) = 0;
+    // Follower: the leader never acked, send it to Spotify directly
+    virtual void journalCommand(uint8_t type, int32_t value, unsigned long queuedAt) = 0;
+    virtual void requestTrackInfo() = 0;
+    // Changes with every completed poll, so a fresh one is published at once
+    virtual unsigned long lastPollTime() = 0;
+};
+
+// Sync counters since the last takeSyncStats()
+struct SyncStats
+{
+    unsigned long packetsIn;
+    unsigned long packetsOut;
+    unsigned long commandRetries;
+    unsigned long commandFallbacks; // Sent directly after the last resend
+};
+
+// Leader election over a shared datagram link. The live node with the
+// lowest ID is the leader: it polls Spotify and sends compact state
+// snapshots. The others stop polling, apply the snapshots and forward
+// player commands to the leader, which acks them. The link may lose
+// packets, so unacked commands are resent and finally journaled for a
+// direct send. When the leader goes quiet the next lowest ID takes over.
+class SyncNode
+{
+public:
+    static const uint16_t MAGIC = 0x5350; // "SP"
+    static const uint8_t VERSION = 4;
+    static const int MAX_PEERS = 8;
+    static const size_t MAX_PACKET = 512;
+    static const unsigned long HEARTBEAT_INTERVAL = 1000; // Leaders send state instead
+    static const unsigned long PEER_TIMEOUT = 3500;       // Silence before a node counts as gone
+    static const unsigned long ACK_TIMEOUT = 150;         // Resend a forwarded command after this
+    static const int MAX_ATTEMPTS = 3;                    // Then Spotify gets it from this node
+    static const int MAX_PENDING = 8;                     // Unacked commands; more are sent directly
+    static const int MAX_HANDLED = 16;                    // Recent commands the leader remembers for dedup
+
+    SyncNode(SyncLink &link, SyncPlayer &player);
+
+    // firstCommandId must differ across restarts, or new commands look like resends
+    void begin(uint32_t id, uint32_t firstCommandId);
+
+    // Read packets, send heartbeats/state and re-run the election
+    void service();
+
+    bool following() const { return leaderId != nodeId; }
+    uint32_t leader() const { return leaderId; }
+    int knownPeers() const { return peerCount; }
+    int pendingCommands() const { return pendingCount; }
+
+    // Follower: hand a player command to the leader
+    bool forwardCommand(uint8_t type, int32_t value);
+
+    SyncStats takeSyncStats();
+
+private:
+    struct Peer
+    {
+        uint32_t id;
+        unsigned long lastSeen;
+    };
+
+    // Forwarded command waiting for the leader's ack
+    struct PendingCommand
+    {
+        uint32_t commandId;
+        uint8_t type;
+        int32_t value;
+        unsigned long queuedAt;
+        unsigned long sentAt;
+        int attempts;
+    };
+
+    // Command the leader already ran, so a resend is only acked
+    struct HandledCommand
+    {
+        uint32_t nodeId;
+        uint32_t commandId;
+    };
+
+    void receive();
+    void handlePacket(const uint8_t *buffer, size_t length);
+    void elect();
+    void sendPending(PendingCommand &command);
+    void retryPending();
+    void handleCommand(uint32_t sender, const uint8_t *body, size_t length);
+    void handleAck(const uint8_t *body, size_t length);
+    void send(SyncPacketType type, const uint8_t *body, size_t bodyLength);
+    SyncHeader header(SyncPacketType type);
+
+    SyncLink &link;
+    SyncPlayer &player;
+    uint32_t nodeId;
+    uint32_t leaderId;
+    uint32_t sequence;
+    uint32_t lastStateSequence;
+    bool stateSequenceKnown; // False until the current leader's first state packet
+    Peer peers[MAX_PEERS];
+    int peerCount;
+    PendingCommand pending[MAX_PENDING]; // Oldest first
+    int pendingCount;
+    uint32_t nextCommandId;
+    HandledCommand handled[MAX_HANDLED];
+    int handledNext;
+    unsigned long lastSent;
+    unsigned long lastPublishedPoll;
+    SyncStats stats;
+};
+
+#endif
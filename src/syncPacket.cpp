@@ -0,0 +1,156 @@
+#include "syncPacket.h"
+
+// Bounds-checked little endian writer/reader over a packet buffer
+struct PacketWriter
+{
+    uint8_t *buffer;
+    size_t size;
+    size_t length;
+    bool overflow;
+
+    void put(const void *data, size_t count)
+    {
+        if (length + count > size)
+        {
+            overflow = true;
+            return;
+        }
+        memcpy(buffer + length, data, count);
+        length += count;
+    }
+    void putU8(uint8_t value) { put(&value, 1); }
+    void putU32(uint32_t value) { put(&value, 4); } // ESP32 and x86 are little endian
+    void putString(const char *value, size_t count)
+    {
+        count = min(count, (size_t)255);
+        putU8(count);
+        put(value, count);
+    }
+};
+
+struct PacketReader
+{
+    const uint8_t *buffer;
+    size_t length;
+    size_t offset;
+    bool underflow;
+
+    bool get(void *data, size_t count)
+    {
+        if (offset + count > length)
+        {
+            underflow = true;
+            return false;
+        }
+        memcpy(data, buffer + offset, count);
+        offset += count;
+        return true;
+    }
+    uint8_t getU8()
+    {
+        uint8_t value = 0;
+        get(&value, 1);
+        return value;
+    }
+    uint32_t getU32()
+    {
+        uint32_t value = 0;
+        get(&value, 4);
+        return value;
+    }
+    template <size_t N>
+    void getString(FixedString<N> &value)
+    {
+        uint8_t count = getU8();
+        if (offset + count > length)
+        {
+            underflow = true;
+            return;
+        }
+        value.assign((const char *)buffer + offset, count);
+        offset += count;
+    }
+};
+
+// Flags, volume, position, duration, then id/song/artist/album
+size_t encodeSyncState(uint8_t *buffer, size_t size, const SyncState &state)
+{
+    PacketWriter writer = {buffer, size, 0, false};
+
+    writer.putU8(state.flags);
+    writer.putU8(state.volume);
+    writer.putU32(state.positionMs);
+    writer.putU32(state.durationMs);
+    writer.putString(state.id.c_str(), state.id.length());
+    writer.putString(state.song.c_str(), state.song.length());
+    writer.putString(state.artist.c_str(), state.artist.length());
+    writer.putString(state.album.c_str(), state.album.length());
+
+    return writer.overflow ? 0 : writer.length;
+}
+
+bool decodeSyncState(const uint8_t *buffer, size_t length, SyncState &state)
+{
+    PacketReader reader = {buffer, length, 0, false};
+
+    state.flags = reader.getU8();
+    state.volume = reader.getU8();
+    state.positionMs = reader.getU32();
+    state.durationMs = reader.getU32();
+    reader.getString(state.id);
+    reader.getString(state.song);
+    reader.getString(state.artist);
+    reader.getString(state.album);
+
+    return !reader.underflow;
+}
+
+size_t encodeSyncCommand(uint8_t *buffer, size_t size, const SyncCommand &command)
+{
+    PacketWriter writer = {buffer, size, 0, false};
+
+    writer.putU32(command.target);
+    writer.putU32(command.commandId);
+    writer.putU8(command.type);
+    writer.putU32((uint32_t)command.value);
+
+    return writer.overflow ? 0 : writer.length;
+}
+
+bool decodeSyncCommand(const uint8_t *buffer, size_t length, SyncCommand &command)
+{
+    PacketReader reader = {buffer, length, 0, false};
+
+    command.target = reader.getU32();
+    command.commandId = reader.getU32();
+    command.type = reader.getU8();
+    command.value = (int32_t)reader.getU32();
+
+    return !reader.underflow;
+}
+
+size_t encodeSyncAck(uint8_t *buffer, size_t size, const SyncAck &ack)
+{
+    PacketWriter writer = {buffer, size, 0, false};
+
+    writer.putU32(ack.target);
+    writer.putU32(ack.commandId);
+
+    return writer.overflow ? 0 : writer.length;
+}
+
+bool decodeSyncAck(const uint8_t *buffer, size_t length, SyncAck &ack)
+{
+    PacketReader reader = {buffer, length, 0, false};
+
+    ack.target = reader.getU32();
+    ack.commandId = reader.getU32();
+
+    return !reader.underflow;
+}
+
+bool syncSequenceNewer(uint32_t sequence, uint32_t last)
+{
+    int32_t step = (int32_t)(sequence - last);
+    return step > 0 || step <= -(int32_t)SYNC_REORDER_WINDOW;
+}
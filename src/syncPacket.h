@@ -0,0 +1,79 @@
+#ifndef SYNCPACKET_H
+#define SYNCPACKET_H
+
+#include <Arduino.h>
+#include "fixedString.h"
+
+// Packet types on the sync group
+enum SyncPacketType : uint8_t
+{
+    SYNC_HEARTBEAT,
+    SYNC_STATE,
+    SYNC_COMMAND,
+    SYNC_ACK
+};
+
+// Every packet starts with this header (little endian, packed)
+struct __attribute__((packed)) SyncHeader
+{
+    uint16_t magic;
+    uint8_t version;
+    uint8_t type;
+    uint32_t nodeId;
+    uint32_t sequence;
+};
+
+// State flags
+#define SYNC_FLAG_ACTIVE 0x01
+#define SYNC_FLAG_PLAYING 0x02
+#define SYNC_FLAG_VOLUME 0x04
+#define SYNC_FLAG_LIKED 0x08
+
+// Playback snapshot carried by a SYNC_STATE packet
+struct SyncState
+{
+    uint8_t flags;
+    uint8_t volume;
+    uint32_t positionMs; // The leader's clock estimate at send time
+    uint32_t durationMs;
+    FixedString<23> id;
+    FixedString<128> song;
+    FixedString<96> artist;
+    FixedString<96> album;
+};
+
+// Player command a follower forwards to the leader. The ID counts per
+// sender, so retries of the same press can be recognised.
+struct SyncCommand
+{
+    uint32_t target; // Leader node ID, every other node ignores it
+    uint32_t commandId;
+    uint8_t type;
+    int32_t value; // Seek positions need all 32 bits
+};
+
+// Leader's receipt for a SyncCommand
+struct SyncAck
+{
+    uint32_t target; // The follower that sent the command
+    uint32_t commandId;
+};
+
+// Late state packets less than this many sequence numbers back are
+// dropped; a bigger step back means the sender restarted
+static const uint32_t SYNC_REORDER_WINDOW = 16;
+
+// Packet body codec, kept free of networking so it runs in host tests.
+// Encoders return 0 when the buffer is too small.
+size_t encodeSyncState(uint8_t *buffer, size_t size, const SyncState &state);
+bool decodeSyncState(const uint8_t *buffer, size_t length, SyncState &state);
+size_t encodeSyncCommand(uint8_t *buffer, size_t size, const SyncCommand &command);
+bool decodeSyncCommand(const uint8_t *buffer, size_t length, SyncCommand &command);
+size_t encodeSyncAck(uint8_t *buffer, size_t size, const SyncAck &ack);
+bool decodeSyncAck(const uint8_t *buffer, size_t length, SyncAck &ack);
+
+// Whether a state packet with this sequence replaces the one from last,
+// across the 32-bit wrap
+bool syncSequenceNewer(uint32_t sequence, uint32_t last);
+
+#endif
@@ -0,0 +1,295 @@
+#include "widgets.h"
+
+Widget::Widget(int16_t x, int16_t y, int16_t w, int16_t h) : x(x),
+                                                             y(y),
+                                                             w(w),
+                                                             h(h),
+                                                             dirty(true)
+{
+}
+
+bool Widget::render(OledDisplay &target)
+{
+    if (!dirty)
+    {
+        return false;
+    }
+
+    draw(target);
+    dirty = false;
+    return true;
+}
+
+void Widget::clear(OledDisplay &target)
+{
+    target.fillRect(x, y, w, h, SH110X_BLACK);
+}
+
+// -------- TEXT --------
+TextWidget::TextWidget(int16_t x, uint8_t page, int16_t w) : Widget(x, page * 8, w, 8),
+                                                             marquee(x, page, w)
+{
+}
+
+void TextWidget::setText(const char *value, unsigned long now)
+{
+    if (text == value)
+    {
+        return;
+    }
+
+    // Only rasterize when the text actually changes
+    text = value;
+    marquee.setText(text.c_str(), now);
+    dirty = true;
+}
+
+void TextWidget::tick(unsigned long now)
+{
+    if (marquee.update(now))
+    {
+        dirty = true;
+    }
+}
+
+void TextWidget::draw(OledDisplay &target)
+{
+    // The strip covers the whole widget, no clear needed
+    marquee.draw(target);
+}
+
+// -------- PROGRESS BAR --------
+ProgressWidget::ProgressWidget(int16_t x, int16_t y, int16_t w, int16_t h) : Widget(x, y, w, h),
+                                                                             fillWidth(0)
+{
+}
+
+void ProgressWidget::setProgress(float positionMs, int durationMs)
+{
+    int16_t newWidth = durationMs > 0 ? constrain(map(positionMs, 0, durationMs, 0, w), 0, w) : 0;
+    if (newWidth != fillWidth)
+    {
+        fillWidth = newWidth;
+        dirty = true;
+    }
+}
+
+void ProgressWidget::draw(OledDisplay &target)
+{
+    clear(target);
+    target.drawRect(x, y, w, h, SH110X_WHITE);
+    target.fillRect(x, y, fillWidth, h, SH110X_WHITE);
+}
+
+// -------- PLAY STATE --------
+PlayStateWidget::PlayStateWidget(int16_t x, int16_t y) : Widget(x, y, 42, 8),
+                                                         playing(false)
+{
+}
+
+void PlayStateWidget::setPlaying(bool value)
+{
+    if (value != playing)
+    {
+        playing = value;
+        dirty = true;
+    }
+}
+
+void PlayStateWidget::draw(OledDisplay &target)
+{
+    clear(target);
+    target.setCursor(x, y);
+    target.print(playing ? "Playing" : "Paused");
+}
+
+// -------- VOLUME --------
+VolumeWidget::VolumeWidget(int16_t x, int16_t y) : Widget(x, y, 18, 8),
+                                                   volumeSupported(false),
+                                                   volume(0)
+{
+}
+
+void VolumeWidget::setVolume(bool supported, int value)
+{
+    if (supported != volumeSupported || value != volume)
+    {
+        volumeSupported = supported;
+        volume = value;
+        dirty = true;
+    }
+}
+
+void VolumeWidget::draw(OledDisplay &target)
+{
+    clear(target);
+    target.setCursor(x, y);
+    if (volumeSupported)
+    {
+        target.print(volume);
+    }
+    else
+    {
+        target.print("N/A");
+    }
+}
+
+// -------- ICON --------
+IconToggleWidget::IconToggleWidget(int16_t x, int16_t y, const PackedBitmap &onBitmap, const PackedBitmap &offBitmap) : Widget(x, y, onBitmap.width, onBitmap.height),
+                                                                                                                       onBitmap(onBitmap),
+                                                                                                                       offBitmap(offBitmap),
+                                                                                                                       state(false)
+{
+}
+
+void IconToggleWidget::setState(bool value)
+{
+    if (value != state)
+    {
+        state = value;
+        dirty = true;
+    }
+}
+
+void IconToggleWidget::draw(OledDisplay &target)
+{
+    clear(target);
+    target.drawPackedBitmap(x, y, state ? onBitmap : offBitmap);
+}
+
+// -------- LIST ROW --------
+ListRowWidget::ListRowWidget(uint8_t page) : Widget(0, page * 8, 128, 8),
+                                             highlighted(false)
+{
+}
+
+void ListRowWidget::setRow(const char *value, bool isHighlighted)
+{
+    if (text == value && highlighted == isHighlighted)
+    {
+        return;
+    }
+
+    text = value;
+    highlighted = isHighlighted;
+    dirty = true;
+}
+
+void ListRowWidget::draw(OledDisplay &target)
+{
+    target.fillRect(x, y, w, h, highlighted ? SH110X_WHITE : SH110X_BLACK);
+    target.setTextColor(highlighted ? SH110X_BLACK : SH110X_WHITE);
+    target.setCursor(x + 2, y);
+    target.print(text.c_str());
+    target.setTextColor(SH110X_WHITE);
+}
+
+// -------- LIST SCREEN --------
+ListScreen::ListScreen() : header(0),
+                           rows{ListRowWidget(1), ListRowWidget(2), ListRowWidget(3), ListRowWidget(4),
+                                ListRowWidget(5), ListRowWidget(6), ListRowWidget(7)},
+                           count(0),
+                           selection(0),
+                           top(0)
+{
+}
+
+void ListScreen::update(const char *title, int itemCount, ListLabel label)
+{
+    count = itemCount;
+    selection = constrain(selection, 0, max(count - 1, 0));
+
+    // Keep the selection in view
+    if (selection < top)
+        top = selection;
+    if (selection >= top + VISIBLE_ROWS)
+        top = selection - VISIBLE_ROWS + 1;
+
+    header.setRow(title, false);
+    for (int i = 0; i < VISIBLE_ROWS; i++)
+    {
+        int index = top + i;
+        rows[i].setRow(index < count ? label(index) : "", index < count && index == selection);
+    }
+}
+
+void ListScreen::move(int delta)
+{
+    selection = constrain(selection + delta, 0, max(count - 1, 0));
+}
+
+bool ListScreen::render(OledDisplay &target)
+{
+    bool drawn = false;
+
+    target.setTextColor(SH110X_WHITE);
+    target.setTextSize(1);
+
+    drawn |= header.render(target);
+    for (int i = 0; i < VISIBLE_ROWS; i++)
+    {
+        drawn |= rows[i].render(target);
+    }
+    return drawn;
+}
+
+void ListScreen::invalidate()
+{
+    header.invalidate();
+    for (int i = 0; i < VISIBLE_ROWS; i++)
+    {
+        rows[i].invalidate();
+    }
+}
+
+// -------- NOW PLAYING SCREEN --------
+NowPlayingScreen::NowPlayingScreen(const PackedBitmap &likedBitmap, const PackedBitmap &notLikedBitmap) : title(0, 0, 128),
+                                                                                                          artist(0, 2, 128),
+                                                                                                          progress(0, 30, 128, 8),
+                                                                                                          playState(45, 55),
+                                                                                                          volume(110, 55),
+                                                                                                          liked(0, 56, likedBitmap, notLikedBitmap)
+{
+    widgets[0] = &title;
+    widgets[1] = &artist;
+    widgets[2] = &progress;
+    widgets[3] = &playState;
+    widgets[4] = &volume;
+    widgets[5] = &liked;
+}
+
+void NowPlayingScreen::update(SpotConn &conn, unsigned long now)
+{
+    const SongDetails &song = conn.getCurrentSong();
+
+    title.setText(song.song.c_str(), now);
+    artist.setText(song.artist.c_str(), now);
+    title.tick(now);
+    artist.tick(now);
+    progress.setProgress(conn.getCurrentPositionMs(), song.durationMs);
+    playState.setPlaying(conn.getStatus());
+    volume.setVolume(conn.volCtrl, conn.currVol);
+    liked.setState(song.isLiked);
+}
+
+bool NowPlayingScreen::render(OledDisplay &target)
+{
+    bool drawn = false;
+
+    target.setTextColor(SH110X_WHITE);
+    target.setTextSize(1);
+
+    for (int i = 0; i < WIDGET_COUNT; i++)
+    {
+        drawn |= widgets[i]->render(target);
+    }
+    return drawn;
+}
+
+void NowPlayingScreen::invalidate()
+{
+    for (int i = 0; i < WIDGET_COUNT; i++)
+    {
+        widgets[i]->invalidate();
+    }
+}
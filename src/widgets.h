@@ -0,0 +1,187 @@
+#ifndef WIDGETS_H
+#define WIDGETS_H
+
+#include <Arduino.h>
+#include "oledDisplay.h"
+#include "spotifyClient.h"
+#include "fixedString.h"
+
+// Retained-mode screen element. Widgets keep the state they last drew and
+// only redraw their own bounding box when that state changes.
+class Widget
+{
+public:
+    Widget(int16_t x, int16_t y, int16_t w, int16_t h);
+    virtual ~Widget() {}
+
+    bool isDirty() const { return dirty; }
+    void invalidate() { dirty = true; }
+
+    // Redraw the widget region if dirty; returns true if anything was drawn
+    bool render(OledDisplay &target);
+
+protected:
+    virtual void draw(OledDisplay &target) = 0;
+    void clear(OledDisplay &target);
+
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+    bool dirty;
+};
+
+// Single line of text that scrolls when it overflows (page aligned)
+class TextWidget : public Widget
+{
+public:
+    TextWidget(int16_t x, uint8_t page, int16_t w);
+
+    void setText(const char *value, unsigned long now);
+    void tick(unsigned long now);
+    bool animating() const { return marquee.scrolls(); }
+
+protected:
+    void draw(OledDisplay &target) override;
+
+private:
+    FixedString<128> text;
+    Marquee marquee;
+};
+
+class ProgressWidget : public Widget
+{
+public:
+    ProgressWidget(int16_t x, int16_t y, int16_t w, int16_t h);
+
+    void setProgress(float positionMs, int durationMs);
+
+protected:
+    void draw(OledDisplay &target) override;
+
+private:
+    int16_t fillWidth;
+};
+
+class PlayStateWidget : public Widget
+{
+public:
+    PlayStateWidget(int16_t x, int16_t y);
+
+    void setPlaying(bool value);
+
+protected:
+    void draw(OledDisplay &target) override;
+
+private:
+    bool playing;
+};
+
+class VolumeWidget : public Widget
+{
+public:
+    VolumeWidget(int16_t x, int16_t y);
+
+    void setVolume(bool supported, int value);
+
+protected:
+    void draw(OledDisplay &target) override;
+
+private:
+    bool volumeSupported;
+    int volume;
+};
+
+class IconToggleWidget : public Widget
+{
+public:
+    IconToggleWidget(int16_t x, int16_t y, const PackedBitmap &onBitmap, const PackedBitmap &offBitmap);
+
+    void setState(bool value);
+
+protected:
+    void draw(OledDisplay &target) override;
+
+private:
+    const PackedBitmap &onBitmap;
+    const PackedBitmap &offBitmap;
+    bool state;
+};
+
+// One text row of a list (page aligned), inverted when highlighted
+class ListRowWidget : public Widget
+{
+public:
+    explicit ListRowWidget(uint8_t page);
+
+    void setRow(const char *value, bool isHighlighted);
+
+protected:
+    void draw(OledDisplay &target) override;
+
+private:
+    FixedString<48> text;
+    bool highlighted;
+};
+
+// Supplies the label of list item `index`; only called for visible rows
+typedef const char *(*ListLabel)(int index);
+
+// Scrolling list with a title row and a highlighted selection
+class ListScreen
+{
+public:
+    ListScreen();
+
+    void update(const char *title, int itemCount, ListLabel label);
+
+    // Move the selection, clamped to the list
+    void move(int delta);
+    void select(int index) { selection = index; }
+    int selected() const { return selection; }
+
+    // Redraw dirty rows; returns true if the display needs a flush
+    bool render(OledDisplay &target);
+
+    void invalidate();
+
+    static const int VISIBLE_ROWS = 7;
+
+private:
+    ListRowWidget header;
+    ListRowWidget rows[VISIBLE_ROWS];
+    int count;
+    int selection;
+    int top;
+};
+
+// Now-playing screen built from retained widgets
+class NowPlayingScreen
+{
+public:
+    NowPlayingScreen(const PackedBitmap &likedBitmap, const PackedBitmap &notLikedBitmap);
+
+    // Feed the latest playback state; widgets mark themselves dirty on change
+    void update(SpotConn &conn, unsigned long now);
+
+    // Redraw dirty widgets; returns true if the display needs a flush
+    bool render(OledDisplay &target);
+
+    void invalidate();
+
+    // True while something on screen changes without new input (scrolling text)
+    bool animating() const { return title.animating() || artist.animating(); }
+
+private:
+    static const int WIDGET_COUNT = 6;
+
+    TextWidget title;
+    TextWidget artist;
+    ProgressWidget progress;
+    PlayStateWidget playState;
+    VolumeWidget volume;
+    IconToggleWidget liked;
+    Widget *widgets[WIDGET_COUNT];
+};
+
+#endif
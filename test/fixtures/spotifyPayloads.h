@@ -0,0 +1,14 @@
+// GET /v1/me/player responses for the host tests. Field set, nesting and
+// sizes follow what the Web API returns for a track played without a market
+// parameter (full available_markets lists), with IDs and names of public
+// catalogue items.
+#ifndef SPOTIFYPAYLOADS_H
+#define SPOTIFYPAYLOADS_H
+
+// Playing a track from a playlist (4263 bytes)
+static const char PLAYER_PAYLOAD[] = R"json({"device":{"id":"2c3d4e5f60718293a4b5c6d7e8f90a1b2c3d4e5f","is_active":true,"is_private_session":false,"is_restricted":false,"name":"Living Room","supports_volume":true,"type":"Speaker","volume_percent":42},"shuffle_state":false,"smart_shuffle":false,"repeat_state":"off","timestamp":1760780000123,"context":{"external_urls":{"spotify":"https://open.spotify.com/playlist/37i9dQZF1DXcBWIGoYBM5M"},"href":"https://api.spotify.com/v1/playlists/37i9dQZF1DXcBWIGoYBM5M","type":"playlist","uri":"spotify:playlist:37i9dQZF1DXcBWIGoYBM5M"},"progress_ms":61234,"item":{"album":{"album_type":"album","artists":[{"external_urls":{"spotify":"https://open.spotify.com/artist/0gxyHStUsqpMadRV0Di1Qt"},"href":"https://api.spotify.com/v1/artists/0gxyHStUsqpMadRV0Di1Qt","id":"0gxyHStUsqpMadRV0Di1Qt","name":"Rick Astley","type":"artist","uri":"spotify:artist:0gxyHStUsqpMadRV0Di1Qt"}],"available_markets":["AR","AU","AT","BE","BO","BR","BG","CA","CL","CO","CR","CY","CZ","DK","DO","DE","EC","EE","SV","FI","FR","GR","GT","HN","HK","HU","IS","IE","IT","LV","LT","LU","MY","MT","MX","NL","NZ","NI","NO","PA","PY","PE","PH","PL","PT","SG","SK","ES","SE","CH","TW","TR","UY","US","GB","AD","LI","MC","ID","JP","TH","VN","RO","IL","ZA","SA","AE","BH","QA","OM","KW","EG","MA","DZ","TN","LB","JO","PS","IN","BY","KZ","MD","UA","AL","BA","HR","ME","MK","RS","SI","KR","BD","PK","LK","GH","KE","NG","TZ","UG","AG","AM","BS","BB","BZ","BT","BW","BF","CV","CW","DM","FJ","GM","GE","GD","GW","GY","HT","JM","KI","LS","LR","MW","MV","ML","MH","FM","NA","NR","NE","PW","PG","PR","WS","SM","ST","SN","SC","SL","SB","KN","LC","VC","SR","TL","TO","TT","TV","VU","AZ","BN","BI","KH","CM","TD","KM","GQ","SZ","GA","GN","KG","LA","MO","MR","MN","NP","RW","TG","UZ","ZW","BJ","MG","MU","MZ","AO","CI","DJ","ZM","CD","CG","IQ","LY","TJ","VE","ET","XK"],"external_urls":{"spotify":"https://open.spotify.com/album/6XzSAfHJL5nOjcVnLJxR9J"},"href":"https://api.spotify.com/v1/albums/6XzSAfHJL5nOjcVnLJxR9J","id":"6XzSAfHJL5nOjcVnLJxR9J","images":[{"height":640,"url":"https://i.scdn.co/image/ab67616d0000b27315ebbedaacef61af244262a8","width":640},{"height":300,"url":"https://i.scdn.co/image/ab67616d00001e0215ebbedaacef61af244262a8","width":300},{"height":64,"url":"https://i.scdn.co/image/ab67616d0000485115ebbedaacef61af244262a8","width":64}],"name":"Whenever You Need Somebody","release_date":"1987-11-12","release_date_precision":"day","total_tracks":10,"type":"album","uri":"spotify:album:6XzSAfHJL5nOjcVnLJxR9J"},"artists":[{"external_urls":{"spotify":"https://open.spotify.com/artist/0gxyHStUsqpMadRV0Di1Qt"},"href":"https://api.spotify.com/v1/artists/0gxyHStUsqpMadRV0Di1Qt","id":"0gxyHStUsqpMadRV0Di1Qt","name":"Rick Astley","type":"artist","uri":"spotify:artist:0gxyHStUsqpMadRV0Di1Qt"}],"available_markets":["AR","AU","AT","BE","BO","BR","BG","CA","CL","CO","CR","CY","CZ","DK","DO","DE","EC","EE","SV","FI","FR","GR","GT","HN","HK","HU","IS","IE","IT","LV","LT","LU","MY","MT","MX","NL","NZ","NI","NO","PA","PY","PE","PH","PL","PT","SG","SK","ES","SE","CH","TW","TR","UY","US","GB","AD","LI","MC","ID","JP","TH","VN","RO","IL","ZA","SA","AE","BH","QA","OM","KW","EG","MA","DZ","TN","LB","JO","PS","IN","BY","KZ","MD","UA","AL","BA","HR","ME","MK","RS","SI","KR","BD","PK","LK","GH","KE","NG","TZ","UG","AG","AM","BS","BB","BZ","BT","BW","BF","CV","CW","DM","FJ","GM","GE","GD","GW","GY","HT","JM","KI","LS","LR","MW","MV","ML","MH","FM","NA","NR","NE","PW","PG","PR","WS","SM","ST","SN","SC","SL","SB","KN","LC","VC","SR","TL","TO","TT","TV","VU","AZ","BN","BI","KH","CM","TD","KM","GQ","SZ","GA","GN","KG","LA","MO","MR","MN","NP","RW","TG","UZ","ZW","BJ","MG","MU","MZ","AO","CI","DJ","ZM","CD","CG","IQ","LY","TJ","VE","ET","XK"],"disc_number":1,"duration_ms":213573,"explicit":false,"external_ids":{"isrc":"GBARL9300135"},"external_urls":{"spotify":"https://open.spotify.com/track/4PTG3Z6ehGkBFwjybzWkR8"},"href":"https://api.spotify.com/v1/tracks/4PTG3Z6ehGkBFwjybzWkR8","id":"4PTG3Z6ehGkBFwjybzWkR8","is_local":false,"name":"Never Gonna Give You Up","popularity":80,"preview_url":null,"track_number":1,"type":"track","uri":"spotify:track:4PTG3Z6ehGkBFwjybzWkR8"},"currently_playing_type":"track","actions":{"disallows":{"resuming":true,"toggling_repeat_track":true}},"is_playing":true})json";
+
+// Paused, long non-ASCII title and three artists (4896 bytes)
+static const char PLAYER_LONG_TITLES_PAYLOAD[] = R"json({"device":{"id":"2c3d4e5f60718293a4b5c6d7e8f90a1b2c3d4e5f","is_active":true,"is_private_session":false,"is_restricted":false,"name":"Living Room","supports_volume":true,"type":"Speaker","volume_percent":42},"shuffle_state":false,"smart_shuffle":false,"repeat_state":"off","timestamp":1760780000123,"context":{"external_urls":{"spotify":"https://open.spotify.com/playlist/37i9dQZF1DXcBWIGoYBM5M"},"href":"https://api.spotify.com/v1/playlists/37i9dQZF1DXcBWIGoYBM5M","type":"playlist","uri":"spotify:playlist:37i9dQZF1DXcBWIGoYBM5M"},"progress_ms":1500,"item":{"album":{"album_type":"album","artists":[{"external_urls":{"spotify":"https://open.spotify.com/artist/0gxyHStUsqpMadRV0Di1Qt"},"href":"https://api.spotify.com/v1/artists/0gxyHStUsqpMadRV0Di1Qt","id":"0gxyHStUsqpMadRV0Di1Qt","name":"Rick Astley","type":"artist","uri":"spotify:artist:0gxyHStUsqpMadRV0Di1Qt"}],"available_markets":["AR","AU","AT","BE","BO","BR","BG","CA","CL","CO","CR","CY","CZ","DK","DO","DE","EC","EE","SV","FI","FR","GR","GT","HN","HK","HU","IS","IE","IT","LV","LT","LU","MY","MT","MX","NL","NZ","NI","NO","PA","PY","PE","PH","PL","PT","SG","SK","ES","SE","CH","TW","TR","UY","US","GB","AD","LI","MC","ID","JP","TH","VN","RO","IL","ZA","SA","AE","BH","QA","OM","KW","EG","MA","DZ","TN","LB","JO","PS","IN","BY","KZ","MD","UA","AL","BA","HR","ME","MK","RS","SI","KR","BD","PK","LK","GH","KE","NG","TZ","UG","AG","AM","BS","BB","BZ","BT","BW","BF","CV","CW","DM","FJ","GM","GE","GD","GW","GY","HT","JM","KI","LS","LR","MW","MV","ML","MH","FM","NA","NR","NE","PW","PG","PR","WS","SM","ST","SN","SC","SL","SB","KN","LC","VC","SR","TL","TO","TT","TV","VU","AZ","BN","BI","KH","CM","TD","KM","GQ","SZ","GA","GN","KG","LA","MO","MR","MN","NP","RW","TG","UZ","ZW","BJ","MG","MU","MZ","AO","CI","DJ","ZM","CD","CG","IQ","LY","TJ","VE","ET","XK"],"external_urls":{"spotify":"https://open.spotify.com/album/6XzSAfHJL5nOjcVnLJxR9J"},"href":"https://api.spotify.com/v1/albums/6XzSAfHJL5nOjcVnLJxR9J","id":"6XzSAfHJL5nOjcVnLJxR9J","images":[{"height":640,"url":"https://i.scdn.co/image/ab67616d0000b27315ebbedaacef61af244262a8","width":640},{"height":300,"url":"https://i.scdn.co/image/ab67616d00001e0215ebbedaacef61af244262a8","width":300},{"height":64,"url":"https://i.scdn.co/image/ab67616d0000485115ebbedaacef61af244262a8","width":64}],"name":"Whenever You Need Somebody","release_date":"1987-11-12","release_date_precision":"day","total_tracks":10,"type":"album","uri":"spotify:album:6XzSAfHJL5nOjcVnLJxR9J"},"artists":[{"external_urls":{"spotify":"https://open.spotify.com/artist/7ltDVBr6mKbRvohxheJ9h1"},"href":"https://api.spotify.com/v1/artists/7ltDVBr6mKbRvohxheJ9h1","id":"7ltDVBr6mKbRvohxheJ9h1","name":"ROSALÍA","type":"artist","uri":"spotify:artist:7ltDVBr6mKbRvohxheJ9h1"},{"external_urls":{"spotify":"https://open.spotify.com/artist/1vyhD5VmyZ7KMfW5gqLgo5"},"href":"https://api.spotify.com/v1/artists/1vyhD5VmyZ7KMfW5gqLgo5","id":"1vyhD5VmyZ7KMfW5gqLgo5","name":"J Balvin","type":"artist","uri":"spotify:artist:1vyhD5VmyZ7KMfW5gqLgo5"},{"external_urls":{"spotify":"https://open.spotify.com/artist/0EmeFodog0BfCgMzAIvKQp"},"href":"https://api.spotify.com/v1/artists/0EmeFodog0BfCgMzAIvKQp","id":"0EmeFodog0BfCgMzAIvKQp","name":"Shakira","type":"artist","uri":"spotify:artist:0EmeFodog0BfCgMzAIvKQp"}],"available_markets":["AR","AU","AT","BE","BO","BR","BG","CA","CL","CO","CR","CY","CZ","DK","DO","DE","EC","EE","SV","FI","FR","GR","GT","HN","HK","HU","IS","IE","IT","LV","LT","LU","MY","MT","MX","NL","NZ","NI","NO","PA","PY","PE","PH","PL","PT","SG","SK","ES","SE","CH","TW","TR","UY","US","GB","AD","LI","MC","ID","JP","TH","VN","RO","IL","ZA","SA","AE","BH","QA","OM","KW","EG","MA","DZ","TN","LB","JO","PS","IN","BY","KZ","MD","UA","AL","BA","HR","ME","MK","RS","SI","KR","BD","PK","LK","GH","KE","NG","TZ","UG","AG","AM","BS","BB","BZ","BT","BW","BF","CV","CW","DM","FJ","GM","GE","GD","GW","GY","HT","JM","KI","LS","LR","MW","MV","ML","MH","FM","NA","NR","NE","PW","PG","PR","WS","SM","ST","SN","SC","SL","SB","KN","LC","VC","SR","TL","TO","TT","TV","VU","AZ","BN","BI","KH","CM","TD","KM","GQ","SZ","GA","GN","KG","LA","MO","MR","MN","NP","RW","TG","UZ","ZW","BJ","MG","MU","MZ","AO","CI","DJ","ZM","CD","CG","IQ","LY","TJ","VE","ET","XK"],"disc_number":1,"duration_ms":402000,"explicit":false,"external_ids":{"isrc":"GBARL9300135"},"external_urls":{"spotify":"https://open.spotify.com/track/4PTG3Z6ehGkBFwjybzWkR8"},"href":"https://api.spotify.com/v1/tracks/4PTG3Z6ehGkBFwjybzWkR8","id":"3n3Ppam7vgaVa1iaRUc9Lp","is_local":false,"name":"Símbolo de una época (Remasterizado 2024) – Versión extendida, en vivo desde el Estadio Nacional, edición aniversario, décimo","popularity":80,"preview_url":null,"track_number":1,"type":"track","uri":"spotify:track:3n3Ppam7vgaVa1iaRUc9Lp"},"currently_playing_type":"track","actions":{"disallows":{"resuming":true,"toggling_repeat_track":true}},"is_playing":false})json";
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Just enough of the Arduino core to build the plain C++ modules on the host
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+// Flash data is plain memory on the host
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+
+// Virtual clock: tests move time forward themselves. Both readings are cut
+// to 32 bits so they wrap the way they do on the ESP32.
+inline uint64_t nativeMicros = 0;
+
+inline unsigned long micros() { return (uint32_t)nativeMicros; }
+inline unsigned long millis() { return (uint32_t)(nativeMicros / 1000); }
+inline void delay(unsigned long ms) { nativeMicros += (uint64_t)ms * 1000; }
+inline void advanceMicros(uint64_t us) { nativeMicros += us; }
+
+#include "WString.h"
+#include "Stream.h"
+
+struct NativeSerial
+{
+    bool muted = false; // Long runs keep the log quiet
+
+    template <typename... Args>
+    void printf(const char *format, Args... args)
+    {
+        if (!muted)
+            ::printf(format, args...);
+    }
+    void print(const char *text)
+    {
+        if (!muted)
+            ::fputs(text, stdout);
+    }
+    void print(const String &text) { print(text.c_str()); }
+    void println(const char *text = "")
+    {
+        if (!muted)
+            ::puts(text);
+    }
+    void println(const String &text) { println(text.c_str()); }
+};
+
+inline NativeSerial Serial;
+
+// Heap readings are whatever the test sets
+inline uint32_t nativeFreeHeap = 200000;
+
+struct NativeEsp
+{
+    uint32_t getFreeHeap() { return nativeFreeHeap; }
+    uint32_t getMinFreeHeap() { return nativeFreeHeap; }
+    uint32_t getMaxAllocHeap() { return nativeFreeHeap; }
+};
+
+inline NativeEsp ESP;
+
+#endif
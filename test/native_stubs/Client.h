@@ -0,0 +1,14 @@
+#ifndef NATIVE_CLIENT_H
+#define NATIVE_CLIENT_H
+
+#include <Arduino.h>
+
+// Connecting is left to the caller (HttpsSession takes a connect function)
+class Client : public Stream
+{
+public:
+    virtual uint8_t connected() = 0;
+    virtual void stop() = 0;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+// The parts of Arduino's String the network code uses, over std::string
+#include <stdlib.h>
+#include <string>
+
+class String
+{
+public:
+    String(const char *text = "") : value(text ? text : "") {}
+    String(const std::string &text) : value(text) {}
+    explicit String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+
+    const char *c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.size(); }
+    void reserve(unsigned int size) { value.reserve(size); }
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : 0; }
+
+    bool concat(const char *text, unsigned int size)
+    {
+        value.append(text, size);
+        return true;
+    }
+
+    String &operator+=(const String &other)
+    {
+        value += other.value;
+        return *this;
+    }
+    String &operator+=(const char *text)
+    {
+        value += text;
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        value += c;
+        return *this;
+    }
+
+    String substring(unsigned int from) const { return from < value.size() ? value.substr(from) : std::string(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        return from < value.size() && from < to ? value.substr(from, to - from) : std::string();
+    }
+    long toInt() const { return atol(value.c_str()); }
+    bool startsWith(const String &prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    int indexOf(const String &text) const
+    {
+        size_t at = value.find(text.value);
+        return at == std::string::npos ? -1 : (int)at;
+    }
+
+    friend bool operator==(const String &a, const String &b) { return a.value == b.value; }
+    friend bool operator!=(const String &a, const String &b) { return a.value != b.value; }
+    friend String operator+(const String &a, const String &b) { return a.value + b.value; }
+
+private:
+    std::string value;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef NATIVE_HEAPCOUNTER_H
+#define NATIVE_HEAPCOUNTER_H
+
+// Counts the heap use of a test binary. Include it from one file per test.
+// On glibc malloc and friends are replaced, which also covers operator new
+// and ArduinoJson's default allocator; elsewhere nothing is counted and
+// HEAP_COUNTER_ACTIVE is false so tests can skip their checks.
+#include <stdlib.h> // Also defines __GLIBC__ where it applies
+
+struct HeapCounter
+{
+    unsigned long allocations; // malloc, calloc and growing reallocs
+    long liveBytes;
+    long peakBytes;
+};
+
+inline HeapCounter heapCounter;
+
+inline void resetHeapPeak() { heapCounter.peakBytes = heapCounter.liveBytes; }
+
+#if defined(__GLIBC__)
+#define HEAP_COUNTER_ACTIVE true
+#include <malloc.h>
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+extern "C" void __libc_free(void *ptr);
+
+static inline void countHeap(long delta)
+{
+    heapCounter.liveBytes += delta;
+    if (heapCounter.liveBytes > heapCounter.peakBytes)
+        heapCounter.peakBytes = heapCounter.liveBytes;
+}
+
+extern "C" void *malloc(size_t size)
+{
+    void *ptr = __libc_malloc(size);
+    if (ptr)
+    {
+        heapCounter.allocations++;
+        countHeap((long)malloc_usable_size(ptr));
+    }
+    return ptr;
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    void *ptr = __libc_calloc(count, size);
+    if (ptr)
+    {
+        heapCounter.allocations++;
+        countHeap((long)malloc_usable_size(ptr));
+    }
+    return ptr;
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    long before = ptr ? (long)malloc_usable_size(ptr) : 0;
+    void *grown = __libc_realloc(ptr, size);
+    if (grown)
+    {
+        long after = (long)malloc_usable_size(grown);
+        if (after > before)
+            heapCounter.allocations++;
+        countHeap(after - before);
+    }
+    else if (size == 0)
+    {
+        countHeap(-before);
+    }
+    return grown;
+}
+
+extern "C" void free(void *ptr)
+{
+    if (ptr)
+        countHeap(-(long)malloc_usable_size(ptr));
+    __libc_free(ptr);
+}
+#else
+#define HEAP_COUNTER_ACTIVE false
+#endif
+
+#endif
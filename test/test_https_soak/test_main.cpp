@@ -0,0 +1,666 @@
+#include <unity.h>
+#include "heapCounter.h"
+#include "httpsSession.h"
+#include "requestScheduler.h"
+#include "soakTest.h"
+
+// What the mock endpoint can do wrong. Response faults hit a random
+// response, connect faults a random connection attempt.
+enum Fault : uint8_t
+{
+    FAULT_NONE,
+    FAULT_STALL,           // No response arrives, the read times out
+    FAULT_STATUS_401,      // Token rejected
+    FAULT_STATUS_429,      // Rate limited, Retry-After: 1
+    FAULT_STATUS_503,      // Service unavailable
+    FAULT_RESET_MID_BODY,  // Connection reset halfway through a body
+    FAULT_STALL_MID_BODY,  // Body stops halfway, the connection stays open
+    FAULT_TRUNCATED_CHUNK, // The last chunk ends early and nothing follows
+    FAULT_SERVER_CLOSE,    // Keep-alive connection closed after the response
+    FAULT_CONNECT,         // DNS lookup or TLS handshake fails
+    FAULT_COUNT
+};
+
+static const char *faultNames[FAULT_COUNT] = {"none", "stall", "401", "429", "503", "reset", "body-stall", "truncated", "close", "connect"};
+
+static const char *PLAYER_FORMAT = "{\"seq\":%ld,\"is_playing\":true,\"progress_ms\":%ld,"
+                                   "\"item\":{\"name\":\"Never Gonna Give You Up\",\"duration_ms\":213573}}";
+static const char *TOKEN_FORMAT = "{\"access_token\":\"soak-%ld\",\"token_type\":\"Bearer\",\"expires_in\":3600}";
+static const char *ERROR_FORMAT = "{\"error\":{\"status\":%d,\"message\":\"Injected\"}}";
+
+static uint32_t nextRandom(uint32_t &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Server end of the connection. Every request written to it is answered;
+// the answer becomes readable after a random latency. Buffers are fixed
+// so the endpoint itself never shows up in the heap count.
+class MockEndpoint : public Client
+{
+public:
+    static const size_t BUFFER_SIZE = 8192;
+    static const int MAX_SEGMENTS = 16;
+
+    int faultRate;  // Per mille of responses and of connection attempts
+    Fault forced;   // Injected into the next response (or connect) instead
+    bool down;      // Network outage: connections drop and cannot be opened
+    bool overflowed;
+    unsigned long connects;
+    unsigned long responses;
+    unsigned long injected[FAULT_COUNT];
+
+    void reset(uint32_t seed, int rate)
+    {
+        random = seed;
+        faultRate = rate;
+        forced = FAULT_NONE;
+        down = false;
+        overflowed = false;
+        connects = 0;
+        responses = 0;
+        memset(injected, 0, sizeof(injected));
+        stop();
+    }
+
+    bool connectTo(const char *host)
+    {
+        stop();
+        connects++;
+        delay(50 + nextRandom(random) % 250); // DNS and TLS handshake
+        if (down || pickFault(true) == FAULT_CONNECT)
+        {
+            Serial.printf("Connection failed: %s\n", host);
+            return false;
+        }
+        open = true;
+        return true;
+    }
+
+    void setDown(bool outage)
+    {
+        down = outage;
+        if (down)
+            stop();
+    }
+
+    uint8_t connected() override { return open || outRead < outLength; }
+
+    void stop() override
+    {
+        open = false;
+        requestLength = 0;
+        outLength = 0;
+        outRead = 0;
+        visible = 0;
+        segmentCount = 0;
+    }
+
+    int available() override
+    {
+        // Answers become readable in order, each once its latency is over
+        while (segmentCount > 0 && (long)(millis() - segmentReadyAt[0]) >= 0)
+        {
+            visible = segmentEnd[0];
+            segmentCount--;
+            memmove(segmentEnd, segmentEnd + 1, sizeof(segmentEnd[0]) * segmentCount);
+            memmove(segmentReadyAt, segmentReadyAt + 1, sizeof(segmentReadyAt[0]) * segmentCount);
+        }
+        return visible - outRead;
+    }
+
+    int read() override
+    {
+        if (available() == 0)
+            return -1;
+        uint8_t c = out[outRead++];
+        if (outRead == outLength && segmentCount == 0)
+        {
+            outLength = outRead = visible = 0;
+        }
+        return c;
+    }
+
+    int peek() override { return available() > 0 ? out[outRead] : -1; }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+
+    size_t write(const uint8_t *buffer, size_t size) override
+    {
+        if (!open)
+            return 0;
+        if (requestLength + size >= sizeof(request))
+        {
+            overflowed = true;
+            return 0;
+        }
+        memcpy(request + requestLength, buffer, size);
+        requestLength += size;
+        request[requestLength] = 0;
+        parseRequests();
+        return size;
+    }
+
+private:
+    Fault pickFault(bool connecting)
+    {
+        if (forced != FAULT_NONE && (forced == FAULT_CONNECT) == connecting)
+        {
+            Fault fault = forced;
+            forced = FAULT_NONE;
+            injected[fault]++;
+            return fault;
+        }
+        if (faultRate == 0 || (int)(nextRandom(random) % 1000) >= faultRate)
+            return FAULT_NONE;
+
+        Fault fault = connecting ? FAULT_CONNECT : (Fault)(FAULT_STALL + nextRandom(random) % (FAULT_CONNECT - FAULT_STALL));
+        injected[fault]++;
+        return fault;
+    }
+
+    // Answer every complete request in the buffer, pipelined ones in order
+    void parseRequests()
+    {
+        char *headEnd;
+        while ((headEnd = strstr(request, "\r\n\r\n")) != nullptr)
+        {
+            size_t headLength = headEnd + 4 - request;
+            size_t bodyLength = 0;
+            const char *contentLength = strstr(request, "Content-Length: ");
+            if (contentLength != nullptr && contentLength < headEnd)
+                bodyLength = atoi(contentLength + 16);
+            if (requestLength < headLength + bodyLength)
+                return;
+
+            char method[8];
+            char path[128];
+            if (sscanf(request, "%7s %127s", method, path) == 2)
+                answer(path);
+
+            requestLength -= headLength + bodyLength;
+            memmove(request, request + headLength + bodyLength, requestLength + 1);
+        }
+    }
+
+    void answer(const char *path)
+    {
+        responses++;
+        Fault fault = pickFault(false);
+        if (fault == FAULT_STALL)
+            return;
+
+        char body[256] = "";
+        int status = 200;
+        long number;
+        bool mayChunk = false;
+        if (sscanf(path, "/v1/me/player?seq=%ld", &number) == 1)
+        {
+            snprintf(body, sizeof(body), PLAYER_FORMAT, number, number * 5000);
+            mayChunk = true;
+        }
+        else if (sscanf(path, "/api/token?n=%ld", &number) == 1)
+        {
+            snprintf(body, sizeof(body), TOKEN_FORMAT, number);
+        }
+        else
+        {
+            status = 204; // Player commands
+        }
+
+        if (fault == FAULT_STATUS_401 || fault == FAULT_STATUS_429 || fault == FAULT_STATUS_503)
+        {
+            status = fault == FAULT_STATUS_401 ? 401 : fault == FAULT_STATUS_429 ? 429 : 503;
+            snprintf(body, sizeof(body), ERROR_FORMAT, status);
+            mayChunk = false;
+        }
+
+        size_t bodyLength = strlen(body);
+        bool chunked = bodyLength > 0 && (fault == FAULT_TRUNCATED_CHUNK || (mayChunk && (nextRandom(random) & 1)));
+        const char *reason = status == 200 ? "OK" : status == 204 ? "No Content" : status == 401 ? "Unauthorized" : status == 429 ? "Too Many Requests" : "Service Unavailable";
+
+        char response[1024];
+        int length = snprintf(response, sizeof(response), "HTTP/1.1 %d %s\r\n", status, reason);
+        if (bodyLength > 0)
+            length += snprintf(response + length, sizeof(response) - length, "Content-Type: application/json\r\n");
+        if (status == 429)
+            length += snprintf(response + length, sizeof(response) - length, "Retry-After: 1\r\n");
+        if (chunked)
+            length += snprintf(response + length, sizeof(response) - length, "Transfer-Encoding: chunked\r\n\r\n");
+        else
+            length += snprintf(response + length, sizeof(response) - length, "Content-Length: %u\r\n\r\n", (unsigned)bodyLength);
+        int headLength = length;
+
+        for (size_t sent = 0; sent < bodyLength;)
+        {
+            size_t chunk = chunked ? min(bodyLength - sent, (size_t)48) : bodyLength;
+            if (chunked)
+                length += snprintf(response + length, sizeof(response) - length, "%x\r\n", (unsigned)chunk);
+            memcpy(response + length, body + sent, chunk);
+            length += chunk;
+            if (chunked)
+                length += snprintf(response + length, sizeof(response) - length, "\r\n");
+            sent += chunk;
+        }
+        if (chunked)
+            length += snprintf(response + length, sizeof(response) - length, "0\r\n\r\n");
+
+        // Where a cut response ends; without a body the headers are cut
+        int half = bodyLength > 0 ? headLength + (length - headLength) / 2 : headLength / 2;
+        switch (fault)
+        {
+        case FAULT_RESET_MID_BODY:
+            queue(response, half);
+            open = false;
+            break;
+        case FAULT_STALL_MID_BODY:
+            queue(response, half);
+            break;
+        case FAULT_TRUNCATED_CHUNK:
+            queue(response, bodyLength > 0 ? length - 12 : half); // Into the last data chunk
+            break;
+        case FAULT_SERVER_CLOSE:
+            queue(response, length);
+            open = false;
+            break;
+        default:
+            queue(response, length);
+            break;
+        }
+    }
+
+    void queue(const char *data, size_t length)
+    {
+        if (outLength + length > BUFFER_SIZE || segmentCount >= MAX_SEGMENTS)
+        {
+            overflowed = true;
+            return;
+        }
+        memcpy(out + outLength, data, length);
+        outLength += length;
+
+        // Later answers never overtake earlier ones
+        unsigned long readyAt = millis() + 20 + nextRandom(random) % 200;
+        if (segmentCount > 0 && (long)(segmentReadyAt[segmentCount - 1] - readyAt) > 0)
+            readyAt = segmentReadyAt[segmentCount - 1];
+        segmentEnd[segmentCount] = outLength;
+        segmentReadyAt[segmentCount] = readyAt;
+        segmentCount++;
+    }
+
+    uint32_t random = 1;
+    bool open = false;
+    char request[1024];
+    size_t requestLength = 0;
+    uint8_t out[BUFFER_SIZE];
+    size_t outLength = 0;
+    size_t outRead = 0;
+    size_t visible = 0; // Bytes of out that have arrived
+    size_t segmentEnd[MAX_SEGMENTS];
+    unsigned long segmentReadyAt[MAX_SEGMENTS];
+    int segmentCount = 0;
+};
+
+static const uint32_t SEED = 0x5eed1234;
+static const int FAULT_RATE = 30;                     // Per mille
+static const unsigned long POLL_INTERVAL = 5000;
+static const unsigned long TOKEN_LIFETIME = 3540000;  // Refreshed a minute before the hour
+static const unsigned long TOKEN_RETRY_INTERVAL = 10000;
+static const unsigned long PRESS_MIN = 20000;         // Between button presses
+static const unsigned long PRESS_SPREAD = 280000;
+static const unsigned long OUTAGE_PERIOD = 6 * 3600000UL;
+static const unsigned long OUTAGE_LENGTH = 8000;
+static const unsigned long CHECK_INTERVAL = 3600000;
+static const uint32_t HEAP_SIZE = 200000;             // Reported to the soak monitor minus what is in use
+static const long HEAP_SLACK = 64;                    // The connected host name may or may not be on the heap
+static const unsigned long DAY = 86400000UL;
+
+// The player side, driven by the request scheduler like the loop in main.cpp
+struct Player
+{
+    uint32_t random;
+    unsigned long lastPoll;
+    unsigned long nextPressAt;
+    unsigned long tokenAt;
+    unsigned long lastTokenTry;
+    unsigned long started;
+    long pollSeq;
+    long tokenSeq;
+    unsigned long polls;
+    unsigned long pollsOk;
+    unsigned long pollsAborted; // Gave way to a button press
+    unsigned long commands;
+    unsigned long commandsOk;
+    unsigned long tokens;
+    unsigned long desyncs; // A response that belongs to another request
+    long heapBaseline;     // -1 until the first hourly check
+    long maxHeapGrowth;
+};
+
+static MockEndpoint endpoint;
+static HttpsSession *session;
+static Player player;
+
+static bool connectMock(const char *host)
+{
+    return endpoint.connectTo(host);
+}
+
+static const JsonDocument &pollFilter()
+{
+    static JsonDocument filter;
+    if (filter.isNull())
+    {
+        filter["seq"] = true;
+        filter["is_playing"] = true;
+        filter["progress_ms"] = true;
+        filter["item"]["name"] = true;
+    }
+    return filter;
+}
+
+// Part of the faulty network only
+static bool outage()
+{
+    return endpoint.faultRate > 0 && (millis() - player.started + OUTAGE_PERIOD / 2) % OUTAGE_PERIOD < OUTAGE_LENGTH;
+}
+
+static bool commandDue()
+{
+    return (long)(millis() - player.nextPressAt) >= 0;
+}
+
+static void runCommand()
+{
+    player.nextPressAt = millis() + PRESS_MIN + nextRandom(player.random) % PRESS_SPREAD;
+    player.commands++;
+
+    if (player.commands % 2)
+    {
+        String response;
+        player.commandsOk += session->request("api.spotify.com", "/v1/me/player/pause", "PUT", "Authorization: Bearer soak\r\n", "", response);
+        return;
+    }
+
+    PipelineRequest requests[2];
+    requests[0].method = "PUT";
+    requests[0].path = "/v1/me/player/volume?volume_percent=40";
+    requests[0].headers = "Authorization: Bearer soak\r\n";
+    requests[0].idempotent = true;
+    requests[1].method = "POST";
+    requests[1].path = "/v1/me/player/next";
+    requests[1].headers = "Authorization: Bearer soak\r\n";
+    player.commandsOk += session->pipeline("api.spotify.com", requests, 2);
+}
+
+static bool tokenDue()
+{
+    bool expiring = millis() - player.tokenAt > TOKEN_LIFETIME;
+    return (expiring || session->authRejected) && millis() - player.lastTokenTry > TOKEN_RETRY_INTERVAL;
+}
+
+static void runToken()
+{
+    player.lastTokenTry = millis();
+    char path[40];
+    snprintf(path, sizeof(path), "/api/token?n=%ld", ++player.tokenSeq);
+
+    String response;
+    if (!session->request("accounts.spotify.com", path, "POST", "Content-Type: application/x-www-form-urlencoded\r\n",
+                          "grant_type=refresh_token&refresh_token=soak", response))
+        return;
+
+    char expected[96];
+    snprintf(expected, sizeof(expected), TOKEN_FORMAT, player.tokenSeq);
+    if (response != expected)
+    {
+        player.desyncs++;
+        return;
+    }
+    player.tokenAt = millis();
+    player.tokens++;
+    session->authRejected = false;
+}
+
+static bool pollDue()
+{
+    return millis() - player.lastPoll >= POLL_INTERVAL;
+}
+
+static void runPoll()
+{
+    player.lastPoll = millis();
+    player.polls++;
+    char path[40];
+    snprintf(path, sizeof(path), "/v1/me/player?seq=%ld", ++player.pollSeq);
+
+    JsonDocument doc;
+    if (!session->requestJson("api.spotify.com", path, "Authorization: Bearer soak\r\n", doc, pollFilter()))
+    {
+        player.pollsAborted += requestScheduler.aborted();
+        return;
+    }
+    if (doc["seq"].as<long>() != player.pollSeq)
+    {
+        player.desyncs++;
+        return;
+    }
+    player.pollsOk++;
+}
+
+// Button presses waiting preempt polls, as userInputWaiting() does on the device
+static bool pressWaiting()
+{
+    return commandDue();
+}
+
+static void startAt(uint64_t ms, int faultRate)
+{
+    nativeMicros = ms * 1000;
+    endpoint.reset(SEED, faultRate);
+    soakMonitor = SoakMonitor();
+
+    player = Player();
+    player.random = SEED ^ 0xA5A5A5A5;
+    player.started = millis();
+    player.lastPoll = millis();
+    player.tokenAt = millis();
+    player.lastTokenTry = millis();
+    player.nextPressAt = millis() + PRESS_MIN;
+    player.heapBaseline = -1;
+}
+
+// Hourly: the soak invariants hold and the heap has not grown since the first check
+static void check()
+{
+    Serial.muted = false; // Broken invariants print why
+    TEST_ASSERT_TRUE(soakMonitor.checkInvariants(nativeFreeHeap));
+    Serial.muted = true;
+
+    if (!HEAP_COUNTER_ACTIVE)
+        return;
+    if (player.heapBaseline < 0)
+    {
+        player.heapBaseline = heapCounter.liveBytes;
+        return;
+    }
+    long growth = heapCounter.liveBytes - player.heapBaseline;
+    player.maxHeapGrowth = max(player.maxHeapGrowth, growth);
+    TEST_ASSERT_LESS_OR_EQUAL(HEAP_SLACK, growth);
+}
+
+static void soak(unsigned long durationMs)
+{
+    Serial.muted = true;
+    unsigned long start = millis();
+    unsigned long lastCheck = start;
+
+    while (millis() - start < durationMs)
+    {
+        if (outage() != endpoint.down)
+            endpoint.setDown(outage());
+        if (!requestScheduler.run())
+            delay(50);
+
+        nativeFreeHeap = HEAP_SIZE - heapCounter.liveBytes;
+        soakMonitor.report();
+
+        if (millis() - lastCheck >= CHECK_INTERVAL)
+        {
+            lastCheck = millis();
+            check();
+        }
+    }
+    Serial.muted = false;
+}
+
+static void printSummary(const char *label, unsigned long durationMs)
+{
+    SoakStats stats = soakMonitor.stats();
+    char line[200];
+
+    snprintf(line, sizeof(line), "%s, %lu h: %lu requests, %lu failed (%lu 4xx, %lu 5xx), %lu reconnects (max %lu/h), %lu recoveries (max %lu ms)",
+             label, durationMs / 3600000, stats.requests, stats.failures, stats.status4xx, stats.status5xx,
+             stats.reconnects, stats.maxReconnectsPerHour, stats.recoveries, stats.maxRecoveryMs);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "polls %lu/%lu (%lu aborted), commands %lu/%lu, tokens %lu, desyncs %lu, heap growth %ld B",
+             player.pollsOk, player.polls, player.pollsAborted, player.commandsOk, player.commands, player.tokens, player.desyncs, player.maxHeapGrowth);
+    TEST_MESSAGE(line);
+
+    int length = snprintf(line, sizeof(line), "injected:");
+    for (int i = FAULT_STALL; i < FAULT_COUNT; i++)
+    {
+        length += snprintf(line + length, sizeof(line) - length, " %s=%lu", faultNames[i], endpoint.injected[i]);
+    }
+    TEST_MESSAGE(line);
+}
+
+void setUp()
+{
+    startAt(0, 0);
+    session = new HttpsSession(endpoint, connectMock);
+    endpoint.setTimeout(10000); // As set on the WiFiClientSecure
+}
+
+void tearDown()
+{
+    delete session;
+    Serial.muted = false;
+}
+
+void test_clean_network_never_fails()
+{
+    soak(DAY);
+    printSummary("clean", DAY);
+
+    SoakStats stats = soakMonitor.stats();
+    // Only polls that gave way to a button press fail
+    TEST_ASSERT_EQUAL(player.pollsAborted, stats.failures);
+    TEST_ASSERT_EQUAL(0, player.desyncs);
+    TEST_ASSERT_EQUAL(player.polls, player.pollsOk + player.pollsAborted);
+    TEST_ASSERT_TRUE(player.pollsAborted > 0);
+    TEST_ASSERT_EQUAL(player.commands, player.commandsOk);
+    TEST_ASSERT_TRUE(player.polls > DAY / POLL_INTERVAL * 9 / 10);
+    // Reconnects only come from the request limit and the token host
+    TEST_ASSERT_LESS_OR_EQUAL(SoakMonitor::MAX_RECONNECTS_PER_HOUR / 4, stats.maxReconnectsPerHour);
+    TEST_ASSERT_FALSE(endpoint.overflowed);
+}
+
+void test_two_weeks_of_faults_keep_the_invariants()
+{
+    startAt(0, FAULT_RATE);
+    soak(14 * DAY);
+    printSummary("faults", 14 * DAY);
+
+    SoakStats stats = soakMonitor.stats();
+    TEST_ASSERT_EQUAL(0, player.desyncs);
+    TEST_ASSERT_FALSE(endpoint.overflowed);
+    for (int i = FAULT_STALL; i < FAULT_COUNT; i++)
+    {
+        TEST_ASSERT_TRUE(endpoint.injected[i] > 0);
+    }
+    TEST_ASSERT_TRUE(stats.recoveries > 0);
+    TEST_ASSERT_LESS_OR_EQUAL(SoakMonitor::MAX_RECONNECTS_PER_HOUR, stats.maxReconnectsPerHour);
+    TEST_ASSERT_LESS_OR_EQUAL(SoakMonitor::MAX_RECOVERY_MS, stats.maxRecoveryMs);
+    TEST_ASSERT_TRUE(player.pollsOk > player.polls * 9 / 10);
+    TEST_ASSERT_TRUE(player.tokens >= 14 * 24);
+}
+
+void test_stalled_body_times_out()
+{
+    String response;
+    TEST_ASSERT_TRUE(session->request("accounts.spotify.com", "/api/token?n=1", "POST", "", "x=1", response));
+
+    endpoint.forced = FAULT_STALL_MID_BODY;
+    unsigned long start = millis();
+    TEST_ASSERT_FALSE(session->request("accounts.spotify.com", "/api/token?n=2", "POST", "", "x=1", response));
+    unsigned long elapsed = millis() - start;
+    TEST_ASSERT_TRUE(elapsed >= HttpsSession::RESPONSE_TIMEOUT && elapsed < HttpsSession::RESPONSE_TIMEOUT + 1000);
+    TEST_ASSERT_FALSE(endpoint.connected()); // The rest would arrive as the next response
+
+    TEST_ASSERT_TRUE(session->request("accounts.spotify.com", "/api/token?n=3", "POST", "", "x=1", response));
+    char expected[96];
+    snprintf(expected, sizeof(expected), TOKEN_FORMAT, 3L);
+    TEST_ASSERT_EQUAL_STRING(expected, response.c_str());
+    TEST_ASSERT_EQUAL(2, endpoint.connects);
+}
+
+void test_retry_after_fails_fast()
+{
+    String response;
+    endpoint.forced = FAULT_STATUS_429;
+    TEST_ASSERT_FALSE(session->request("api.spotify.com", "/v1/me/player/pause", "PUT", "", "", response));
+    TEST_ASSERT_EQUAL(429, session->lastStatusCode());
+
+    // Inside the Retry-After window nothing goes out
+    unsigned long responses = endpoint.responses;
+    TEST_ASSERT_FALSE(session->request("api.spotify.com", "/v1/me/player/pause", "PUT", "", "", response));
+    TEST_ASSERT_FALSE(session->lastRequestWritten());
+    TEST_ASSERT_EQUAL(responses, endpoint.responses);
+
+    delay(1000);
+    TEST_ASSERT_TRUE(session->request("api.spotify.com", "/v1/me/player/pause", "PUT", "", "", response));
+    TEST_ASSERT_EQUAL(1, endpoint.connects); // A status alone keeps the connection
+}
+
+void test_dropped_pipeline_retries_only_idempotent_requests()
+{
+    PipelineRequest requests[2];
+    requests[0].method = "PUT";
+    requests[0].path = "/v1/me/player/volume?volume_percent=40";
+    requests[0].idempotent = true;
+    requests[1].method = "POST";
+    requests[1].path = "/v1/me/player/next";
+
+    // The first answer is cut in its headers, the second request is lost
+    // on the reset connection; the client cannot tell it never arrived
+    endpoint.forced = FAULT_RESET_MID_BODY;
+    TEST_ASSERT_FALSE(session->pipeline("api.spotify.com", requests, 2));
+
+    TEST_ASSERT_TRUE(requests[0].completed); // Repeated on a new connection
+    TEST_ASSERT_EQUAL(204, requests[0].statusCode);
+    TEST_ASSERT_TRUE(requests[1].written);
+    TEST_ASSERT_FALSE(requests[1].completed); // May already have skipped
+    TEST_ASSERT_EQUAL(0, requests[1].statusCode);
+    TEST_ASSERT_EQUAL(2, endpoint.responses);
+    TEST_ASSERT_EQUAL(2, endpoint.connects);
+}
+
+int main()
+{
+    requestScheduler.addJob(REQUEST_COMMAND, commandDue, runCommand);
+    requestScheduler.addJob(REQUEST_TOKEN, tokenDue, runToken);
+    requestScheduler.addJob(REQUEST_POLL, pollDue, runPoll);
+    requestScheduler.setPreemptCheck(pressWaiting);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_stalled_body_times_out);
+    RUN_TEST(test_retry_after_fails_fast);
+    RUN_TEST(test_dropped_pipeline_retries_only_idempotent_requests);
+    RUN_TEST(test_clean_network_never_fails);
+    RUN_TEST(test_two_weeks_of_faults_keep_the_invariants);
+    return UNITY_END();
+}
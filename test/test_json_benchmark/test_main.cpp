@@ -0,0 +1,184 @@
+#include <unity.h>
+#include <chrono>
+#include "jsonPool.h"
+#include "songDetails.h"
+#include "spotifyPayloads.h"
+
+// Parse cost of /v1/me/player responses: the plain heap JsonDocument the
+// client used before the pools, against the filtered parse into the arena.
+// Times are host times, only the ratio carries over to the ESP32.
+
+static const int ROUNDS = 2000;
+
+// Same size as the player arena in spotifyClient.cpp
+static uint8_t playerArena[3072] __attribute__((aligned(8)));
+
+// Heap allocator that keeps the high-water mark of one document
+class CountingAllocator : public ArduinoJson::Allocator
+{
+public:
+    void *allocate(size_t size) override
+    {
+        size_t *block = (size_t *)malloc(HEADER + size);
+        if (block == nullptr)
+            return nullptr;
+        *block = size;
+        track(size);
+        return (uint8_t *)block + HEADER;
+    }
+
+    void deallocate(void *ptr) override
+    {
+        if (ptr == nullptr)
+            return;
+        size_t *block = (size_t *)((uint8_t *)ptr - HEADER);
+        live -= *block;
+        free(block);
+    }
+
+    void *reallocate(void *ptr, size_t newSize) override
+    {
+        if (ptr == nullptr)
+            return allocate(newSize);
+        size_t *block = (size_t *)((uint8_t *)ptr - HEADER);
+        size_t oldSize = *block;
+        block = (size_t *)realloc(block, HEADER + newSize);
+        if (block == nullptr)
+            return nullptr;
+        *block = newSize;
+        live -= oldSize;
+        track(newSize);
+        return (uint8_t *)block + HEADER;
+    }
+
+    size_t peak() const { return peakLive; }
+
+private:
+    static const size_t HEADER = 16; // Keeps the payload aligned like malloc
+
+    void track(size_t size)
+    {
+        live += size;
+        if (live > peakLive)
+            peakLive = live;
+    }
+
+    size_t live = 0;
+    size_t peakLive = 0;
+};
+
+struct ParseCost
+{
+    double microseconds; // Mean per parse
+    size_t peakBytes;
+};
+
+static double elapsedUs(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+// Before the pools: one heap document per response, nothing filtered
+static ParseCost parsePlain(const char *payload)
+{
+    CountingAllocator allocator;
+    ParseCost cost;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        JsonDocument doc(&allocator);
+        DeserializationError error = deserializeJson(doc, payload);
+        TEST_ASSERT_FALSE(error);
+    }
+    cost.microseconds = elapsedUs(start) / ROUNDS;
+    cost.peakBytes = allocator.peak();
+    return cost;
+}
+
+// Now: the shared player filter into the reused arena
+static ParseCost parsePooled(const char *payload)
+{
+    ArenaAllocator arena(playerArena, sizeof(playerArena));
+    JsonDocument doc(&arena);
+    ParseCost cost;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        DeserializationError error = deserializeJson(doc, payload,
+                                                     DeserializationOption::Filter(playerFilter()));
+        TEST_ASSERT_FALSE(error);
+        doc.clear();
+        arena.reset();
+    }
+    cost.microseconds = elapsedUs(start) / ROUNDS;
+    cost.peakBytes = arena.peak();
+    return cost;
+}
+
+static void report(const char *name, const char *payload, const ParseCost &plain, const ParseCost &pooled)
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%s (%u B): plain %.1f us %u B peak, pooled %.1f us %u B peak",
+             name, (unsigned)strlen(payload),
+             plain.microseconds, (unsigned)plain.peakBytes,
+             pooled.microseconds, (unsigned)pooled.peakBytes);
+    TEST_MESSAGE(line);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void benchmark(const char *name, const char *payload)
+{
+    playerFilter(); // Built once at startup on the device, not per parse
+    ParseCost plain = parsePlain(payload);
+    ParseCost pooled = parsePooled(payload);
+    report(name, payload, plain, pooled);
+
+    TEST_ASSERT_TRUE(pooled.peakBytes <= sizeof(playerArena));
+    TEST_ASSERT_TRUE(pooled.peakBytes < plain.peakBytes);
+}
+
+void test_player_payload()
+{
+    benchmark("player", PLAYER_PAYLOAD);
+}
+
+void test_player_long_titles_payload()
+{
+    benchmark("player, long titles", PLAYER_LONG_TITLES_PAYLOAD);
+}
+
+void test_pooled_parse_keeps_the_song_fields()
+{
+    ArenaAllocator arena(playerArena, sizeof(playerArena));
+    JsonDocument doc(&arena);
+    JsonDocument plain;
+
+    TEST_ASSERT_FALSE(deserializeJson(doc, PLAYER_PAYLOAD, DeserializationOption::Filter(playerFilter())));
+    TEST_ASSERT_FALSE(deserializeJson(plain, PLAYER_PAYLOAD));
+
+    SongDetails fromPool;
+    SongDetails fromPlain;
+    readSongDetails(doc["item"], fromPool);
+    readSongDetails(plain["item"], fromPlain);
+
+    TEST_ASSERT_EQUAL_STRING(fromPlain.artist.c_str(), fromPool.artist.c_str());
+    TEST_ASSERT_EQUAL_STRING(fromPlain.song.c_str(), fromPool.song.c_str());
+    TEST_ASSERT_EQUAL_STRING(fromPlain.Id.c_str(), fromPool.Id.c_str());
+    TEST_ASSERT_EQUAL(fromPlain.durationMs, fromPool.durationMs);
+    TEST_ASSERT_EQUAL(plain["progress_ms"].as<long>(), doc["progress_ms"].as<long>());
+    TEST_ASSERT_EQUAL(plain["device"]["volume_percent"].as<int>(), doc["device"]["volume_percent"].as<int>());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_player_payload);
+    RUN_TEST(test_player_long_titles_payload);
+    RUN_TEST(test_pooled_parse_keeps_the_song_fields);
+    return UNITY_END();
+}
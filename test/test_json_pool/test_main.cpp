@@ -0,0 +1,140 @@
+#include <unity.h>
+#include "jsonPool.h"
+
+static uint8_t buffer[256] __attribute__((aligned(8)));
+
+void setUp() {}
+void tearDown() {}
+
+void test_allocations_are_aligned_and_counted()
+{
+    ArenaAllocator arena(buffer, sizeof(buffer));
+
+    uint8_t *first = (uint8_t *)arena.allocate(3);
+    uint8_t *second = (uint8_t *)arena.allocate(10);
+
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)first % 8);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)second % 8);
+    TEST_ASSERT_EQUAL(8 + 8 + 8 + 16, arena.used()); // Header plus rounded size each
+}
+
+void test_exhausted_arena_returns_null()
+{
+    ArenaAllocator arena(buffer, sizeof(buffer));
+
+    TEST_ASSERT_NOT_NULL(arena.allocate(sizeof(buffer) - 8));
+    TEST_ASSERT_NULL(arena.allocate(1));
+    TEST_ASSERT_EQUAL(sizeof(buffer), arena.used());
+}
+
+void test_reset_rewinds_and_keeps_peak()
+{
+    ArenaAllocator arena(buffer, sizeof(buffer));
+
+    arena.allocate(100);
+    size_t peak = arena.peak();
+    arena.reset();
+
+    TEST_ASSERT_EQUAL(0, arena.used());
+    TEST_ASSERT_EQUAL(peak, arena.peak());
+    TEST_ASSERT_EQUAL_PTR(buffer + 8, arena.allocate(100));
+}
+
+void test_last_block_grows_and_shrinks_in_place()
+{
+    ArenaAllocator arena(buffer, sizeof(buffer));
+
+    void *block = arena.allocate(16);
+    TEST_ASSERT_EQUAL_PTR(block, arena.reallocate(block, 64));
+    TEST_ASSERT_EQUAL(8 + 64, arena.used());
+    TEST_ASSERT_EQUAL_PTR(block, arena.reallocate(block, 8));
+    TEST_ASSERT_EQUAL(8 + 8, arena.used());
+    TEST_ASSERT_NULL(arena.reallocate(block, sizeof(buffer)));
+}
+
+void test_older_block_moves_and_keeps_contents()
+{
+    ArenaAllocator arena(buffer, sizeof(buffer));
+
+    char *older = (char *)arena.allocate(8);
+    memcpy(older, "abcdefg", 8);
+    arena.allocate(8);
+
+    char *moved = (char *)arena.reallocate(older, 32);
+    TEST_ASSERT_NOT_NULL(moved);
+    TEST_ASSERT_TRUE(moved != older);
+    TEST_ASSERT_EQUAL_STRING("abcdefg", moved);
+}
+
+void test_deallocate_returns_only_the_last_block()
+{
+    ArenaAllocator arena(buffer, sizeof(buffer));
+
+    void *first = arena.allocate(8);
+    void *second = arena.allocate(8);
+    arena.deallocate(first);
+    TEST_ASSERT_EQUAL(32, arena.used());
+    arena.deallocate(second);
+    TEST_ASSERT_EQUAL(16, arena.used());
+}
+
+void test_parse_uses_only_the_arena()
+{
+    static uint8_t parseBuffer[2048] __attribute__((aligned(8)));
+    ArenaAllocator arena(parseBuffer, sizeof(parseBuffer));
+    JsonDocument doc(&arena);
+
+    DeserializationError error = deserializeJson(doc, "{\"is_playing\":true,\"item\":{\"name\":\"Song\",\"duration_ms\":1000}}");
+
+    TEST_ASSERT_FALSE(error);
+    TEST_ASSERT_EQUAL_STRING("Song", doc["item"]["name"]);
+    TEST_ASSERT_TRUE(arena.used() > 0);
+}
+
+void test_parse_into_small_arena_fails_with_no_memory()
+{
+    static uint8_t tinyBuffer[64] __attribute__((aligned(8)));
+    ArenaAllocator arena(tinyBuffer, sizeof(tinyBuffer));
+    JsonDocument doc(&arena);
+
+    DeserializationError error = deserializeJson(doc, "{\"a\":[1,2,3,4,5,6,7,8],\"b\":\"a string that needs room\"}");
+
+    TEST_ASSERT_TRUE(error == DeserializationError::NoMemory);
+    TEST_ASSERT_TRUE(arena.used() <= sizeof(tinyBuffer));
+}
+
+void test_lease_releases_the_pool()
+{
+    static uint8_t poolBuffer[2048] __attribute__((aligned(8)));
+    JsonPool pool(poolBuffer, sizeof(poolBuffer), "test");
+
+    {
+        JsonPoolLease lease(pool);
+        deserializeJson(lease.doc(), "{\"id\":\"abc\"}");
+        TEST_ASSERT_EQUAL_STRING("abc", lease.doc()["id"]);
+    }
+
+    TEST_ASSERT_TRUE(pool.doc().isNull());
+
+    // The same pool parses again after the release
+    JsonPoolLease lease(pool);
+    TEST_ASSERT_FALSE(deserializeJson(lease.doc(), "{\"id\":\"def\"}"));
+    TEST_ASSERT_EQUAL_STRING("def", lease.doc()["id"]);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_allocations_are_aligned_and_counted);
+    RUN_TEST(test_exhausted_arena_returns_null);
+    RUN_TEST(test_reset_rewinds_and_keeps_peak);
+    RUN_TEST(test_last_block_grows_and_shrinks_in_place);
+    RUN_TEST(test_older_block_moves_and_keeps_contents);
+    RUN_TEST(test_deallocate_returns_only_the_last_block);
+    RUN_TEST(test_parse_uses_only_the_arena);
+    RUN_TEST(test_parse_into_small_arena_fails_with_no_memory);
+    RUN_TEST(test_lease_releases_the_pool);
+    return UNITY_END();
+}
@@ -0,0 +1,134 @@
+#include <unity.h>
+#include "latencyTrace.h"
+
+static LatencyTracer tracer;
+
+void setUp()
+{
+    tracer = LatencyTracer();
+}
+
+void tearDown() {}
+
+// One command through every stage; the frame lands before Spotify answers
+static void trace(TraceCommand command, uint32_t startUs, uint32_t displayUs, uint32_t ackUs)
+{
+    tracer.begin(command, startUs);
+    tracer.markAt(TRACE_DISPATCH, startUs + 100);
+    tracer.markAt(TRACE_SENT, startUs + 200);
+    tracer.markAt(TRACE_STATE_UPDATE, startUs + 300);
+    tracer.markAt(TRACE_DRAW, startUs + 400);
+    tracer.markAt(TRACE_HANDOFF, startUs + 500);
+    tracer.markAt(TRACE_FLUSH, startUs + displayUs);
+    tracer.markAt(TRACE_FIRST_BYTE, startUs + ackUs);
+}
+
+void test_percentiles_of_scrambled_samples()
+{
+    // 1..64 ms in a scrambled order (37 is coprime with 64)
+    for (int i = 0; i < 64; i++)
+    {
+        uint32_t ms = (i * 37) % 64 + 1;
+        trace(TRACE_CMD_PLAY, i * 1000000, ms * 1000, ms * 2000);
+    }
+
+    LatencyPercentiles display = tracer.displayLatency(TRACE_CMD_PLAY);
+    TEST_ASSERT_EQUAL(64, display.count);
+    TEST_ASSERT_EQUAL_UINT32(33000, display.p50Us);
+    TEST_ASSERT_EQUAL_UINT32(61000, display.p95Us);
+    TEST_ASSERT_EQUAL_UINT32(64000, display.p99Us);
+
+    LatencyPercentiles spotify = tracer.spotifyLatency(TRACE_CMD_PLAY);
+    TEST_ASSERT_EQUAL_UINT32(66000, spotify.p50Us);
+    TEST_ASSERT_EQUAL_UINT32(128000, spotify.p99Us);
+}
+
+void test_only_newest_samples_are_kept()
+{
+    for (int i = 0; i < LatencyTracer::SAMPLES; i++)
+        trace(TRACE_CMD_NEXT, i * 1000000, 500000, 600000);
+    for (int i = 0; i < LatencyTracer::SAMPLES; i++)
+        trace(TRACE_CMD_NEXT, (LatencyTracer::SAMPLES + i) * 1000000, 100000, 200000);
+
+    LatencyPercentiles display = tracer.displayLatency(TRACE_CMD_NEXT);
+    TEST_ASSERT_EQUAL(LatencyTracer::SAMPLES, display.count);
+    TEST_ASSERT_EQUAL_UINT32(100000, display.p50Us);
+    TEST_ASSERT_EQUAL_UINT32(100000, display.p99Us);
+}
+
+void test_commands_are_kept_apart()
+{
+    trace(TRACE_CMD_PLAY, 0, 10000, 20000);
+    trace(TRACE_CMD_VOLUME, 1000000, 50000, 60000);
+
+    TEST_ASSERT_EQUAL_UINT32(10000, tracer.displayLatency(TRACE_CMD_PLAY).p99Us);
+    TEST_ASSERT_EQUAL_UINT32(50000, tracer.displayLatency(TRACE_CMD_VOLUME).p99Us);
+
+    LatencyPercentiles like = tracer.displayLatency(TRACE_CMD_LIKE);
+    TEST_ASSERT_EQUAL(0, like.count);
+    TEST_ASSERT_EQUAL_UINT32(0, like.p50Us);
+}
+
+void test_frames_before_the_state_update_do_not_count()
+{
+    tracer.begin(TRACE_CMD_LIKE, 0);
+    tracer.markAt(TRACE_DRAW, 5000);
+    tracer.markAt(TRACE_HANDOFF, 6000);
+    tracer.markAt(TRACE_FLUSH, 8000); // Still the old frame
+    tracer.markAt(TRACE_STATE_UPDATE, 20000);
+    tracer.markAt(TRACE_FLUSH, 22000); // No draw or handoff yet
+    tracer.markAt(TRACE_DRAW, 25000);
+    tracer.markAt(TRACE_HANDOFF, 26000);
+    tracer.markAt(TRACE_FLUSH, 30000);
+    TEST_ASSERT_EQUAL(0, tracer.displayLatency(TRACE_CMD_LIKE).count); // Waits for the ack
+    tracer.markAt(TRACE_FIRST_BYTE, 40000);
+
+    LatencyPercentiles display = tracer.displayLatency(TRACE_CMD_LIKE);
+    TEST_ASSERT_EQUAL(1, display.count);
+    TEST_ASSERT_EQUAL_UINT32(30000, display.p50Us);
+    TEST_ASSERT_EQUAL_UINT32(40000, tracer.spotifyLatency(TRACE_CMD_LIKE).p50Us);
+}
+
+void test_timed_out_trace_is_dropped()
+{
+    tracer.begin(TRACE_CMD_PREV, 0);
+    tracer.markAt(TRACE_STATE_UPDATE, 1000);
+    tracer.markAt(TRACE_DRAW, 2000);
+    tracer.markAt(TRACE_HANDOFF, 3000);
+    tracer.markAt(TRACE_FLUSH, 4000);
+    tracer.markAt(TRACE_FIRST_BYTE, LatencyTracer::TRACE_TIMEOUT_US + 1);
+
+    TEST_ASSERT_EQUAL(0, tracer.spotifyLatency(TRACE_CMD_PREV).count);
+}
+
+void test_superseded_trace_is_dropped()
+{
+    tracer.begin(TRACE_CMD_PLAY, 0);
+    tracer.markAt(TRACE_STATE_UPDATE, 1000);
+    trace(TRACE_CMD_PLAY, 500000, 15000, 25000);
+
+    LatencyPercentiles display = tracer.displayLatency(TRACE_CMD_PLAY);
+    TEST_ASSERT_EQUAL(1, display.count);
+    TEST_ASSERT_EQUAL_UINT32(15000, display.p50Us);
+}
+
+void test_timestamps_across_the_micros_wrap()
+{
+    trace(TRACE_CMD_PLAY, 0xFFFFF000, 10000, 20000);
+
+    TEST_ASSERT_EQUAL_UINT32(10000, tracer.displayLatency(TRACE_CMD_PLAY).p50Us);
+    TEST_ASSERT_EQUAL_UINT32(20000, tracer.spotifyLatency(TRACE_CMD_PLAY).p50Us);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_percentiles_of_scrambled_samples);
+    RUN_TEST(test_only_newest_samples_are_kept);
+    RUN_TEST(test_commands_are_kept_apart);
+    RUN_TEST(test_frames_before_the_state_update_do_not_count);
+    RUN_TEST(test_timed_out_trace_is_dropped);
+    RUN_TEST(test_superseded_trace_is_dropped);
+    RUN_TEST(test_timestamps_across_the_micros_wrap);
+    return UNITY_END();
+}
@@ -0,0 +1,230 @@
+#include <unity.h>
+#include <chrono>
+#include <vector>
+#include "packedBitmap.h"
+#include "bitmaps.h"
+
+static const int SCREEN_WIDTH = 128;
+static const int SCREEN_HEIGHT = 64;
+
+typedef std::vector<uint8_t> Bytes;
+
+// Same encoding as rle() in tools/build_assets.py
+static Bytes rle(const Bytes &data)
+{
+    Bytes out;
+    size_t i = 0;
+    while (i < data.size())
+    {
+        size_t run = 1;
+        while (i + run < data.size() && data[i + run] == data[i] && run < 129)
+            run++;
+        if (run >= 2)
+        {
+            out.push_back(run + 126);
+            out.push_back(data[i]);
+            i += run;
+            continue;
+        }
+
+        size_t start = i;
+        while (i < data.size() && i - start < 128)
+        {
+            if (i + 1 < data.size() && data[i + 1] == data[i])
+                break;
+            i++;
+        }
+        out.push_back(i - start - 1);
+        out.insert(out.end(), data.begin() + start, data.begin() + i);
+    }
+    return out;
+}
+
+static Bytes xorBytes(const Bytes &a, const Bytes &b)
+{
+    Bytes out(a.size());
+    for (size_t i = 0; i < a.size(); i++)
+        out[i] = a[i] ^ b[i];
+    return out;
+}
+
+// Page-major bytes of a width x height image, with long runs and noise
+static Bytes makePages(int width, int height, uint32_t seed)
+{
+    Bytes pages(width * ((height + 7) / 8));
+    for (size_t i = 0; i < pages.size(); i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int region = (i / 40) % 3;
+        pages[i] = region == 0 ? 0x00 : region == 1 ? 0xFF : (uint8_t)(seed >> 16);
+    }
+    return pages;
+}
+
+static PackedBitmap pack(int width, int height, const Bytes &packed, const PackedBitmap *base)
+{
+    PackedBitmap bitmap = {(uint8_t)width, (uint8_t)height, (uint16_t)packed.size(), packed.data(), base};
+    return bitmap;
+}
+
+// Decode on its own: a buffer exactly the size of the bitmap
+static Bytes unpack(const PackedBitmap &bitmap)
+{
+    int pages = (bitmap.height + 7) / 8;
+    Bytes out(bitmap.width * pages);
+    blitPackedBitmap(out.data(), bitmap.width, pages * 8, 0, 0, bitmap);
+    return out;
+}
+
+static bool pixel(const uint8_t *pages, int width, int x, int y)
+{
+    return pages[x + (y / 8) * width] & (1 << (y & 7));
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_round_trip_of_runs_and_literals()
+{
+    const int sizes[][2] = {{128, 64}, {7, 6}, {112, 49}, {1, 1}, {255, 16}};
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        Bytes pages = makePages(sizes[s][0], sizes[s][1], s + 1);
+        Bytes packed = rle(pages);
+        TEST_ASSERT_TRUE(unpack(pack(sizes[s][0], sizes[s][1], packed, nullptr)) == pages);
+    }
+}
+
+void test_longest_runs_and_literals()
+{
+    Bytes pages(1000, 0xAA); // Runs of 129 and a short tail
+    for (int i = 300; i < 600; i++)
+        pages[i] = i; // Literal blocks of 128
+    Bytes packed = rle(pages);
+
+    TEST_ASSERT_EQUAL(0xFF, packed[0]); // 129 repeats
+    TEST_ASSERT_TRUE(unpack(pack(250, 32, packed, nullptr)) == pages);
+}
+
+void test_delta_chain_decodes_to_the_top_frame()
+{
+    Bytes first = makePages(64, 32, 7);
+    Bytes second = first;
+    Bytes third = first;
+    for (int i = 0; i < 40; i++)
+        second[100 + i] ^= 0x18;
+    for (int i = 0; i < 10; i++)
+        third[200 + i] = 0x3C;
+
+    Bytes firstPacked = rle(first);
+    Bytes secondPacked = rle(xorBytes(second, first));
+    Bytes thirdPacked = rle(xorBytes(third, second));
+    PackedBitmap firstBitmap = pack(64, 32, firstPacked, nullptr);
+    PackedBitmap secondBitmap = pack(64, 32, secondPacked, &firstBitmap);
+    PackedBitmap thirdBitmap = pack(64, 32, thirdPacked, &secondBitmap);
+
+    TEST_ASSERT_TRUE(unpack(secondBitmap) == second);
+    TEST_ASSERT_TRUE(unpack(thirdBitmap) == third);
+    TEST_ASSERT_TRUE(secondPacked.size() < firstPacked.size());
+}
+
+void test_unaligned_and_clipped_draws()
+{
+    Bytes source = makePages(40, 20, 3);
+    Bytes packed = rle(source);
+    PackedBitmap bitmap = pack(40, 20, packed, nullptr);
+
+    const int positions[][2] = {{0, 3}, {10, 13}, {100, 50}, {-7, -5}, {-39, 61}, {127, 0}};
+    for (unsigned p = 0; p < sizeof(positions) / sizeof(positions[0]); p++)
+    {
+        int x = positions[p][0];
+        int y = positions[p][1];
+        uint8_t screen[SCREEN_WIDTH * SCREEN_HEIGHT / 8] = {0};
+        blitPackedBitmap(screen, SCREEN_WIDTH, SCREEN_HEIGHT, x, y, bitmap);
+
+        // Every screen pixel is the source pixel under it, or off
+        for (int sy = 0; sy < SCREEN_HEIGHT; sy++)
+        {
+            for (int sx = 0; sx < SCREEN_WIDTH; sx++)
+            {
+                int bx = sx - x;
+                int by = sy - y;
+                bool expected = bx >= 0 && bx < 40 && by >= 0 && by < 24 && pixel(source.data(), 40, bx, by);
+                TEST_ASSERT_EQUAL(expected, pixel(screen, SCREEN_WIDTH, sx, sy));
+            }
+        }
+    }
+}
+
+void test_aligned_draw_replaces_unaligned_draw_merges()
+{
+    Bytes source(16, 0x0F);
+    Bytes packed = rle(source);
+    PackedBitmap bitmap = pack(16, 8, packed, nullptr);
+    uint8_t screen[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+
+    memset(screen, 0xF0, sizeof(screen));
+    blitPackedBitmap(screen, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 8, bitmap);
+    TEST_ASSERT_EQUAL(0x0F, screen[SCREEN_WIDTH]);
+
+    // Rows 4..7 land in the top half of page 0, over what is there
+    memset(screen, 0x0F, sizeof(screen));
+    blitPackedBitmap(screen, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 4, bitmap);
+    TEST_ASSERT_EQUAL(0xFF, screen[0]);
+    TEST_ASSERT_EQUAL(0x0F, screen[SCREEN_WIDTH]);
+}
+
+void test_generated_assets_match_the_encoder()
+{
+    const PackedBitmap *assets[] = {&no_active_device, &configuring, &heart_filled, &heart_outline};
+    for (unsigned a = 0; a < sizeof(assets) / sizeof(assets[0]); a++)
+    {
+        Bytes packed = rle(unpack(*assets[a]));
+        TEST_ASSERT_EQUAL(assets[a]->size, packed.size());
+        TEST_ASSERT_EQUAL_MEMORY(assets[a]->data, packed.data(), packed.size());
+    }
+
+    // The splash screen is stored as a delta against the no device screen
+    Bytes delta = xorBytes(unpack(splash_screen), unpack(no_active_device));
+    Bytes packed = rle(delta);
+    TEST_ASSERT_EQUAL(splash_screen.size, packed.size());
+    TEST_ASSERT_EQUAL_MEMORY(splash_screen.data, packed.data(), packed.size());
+
+    const uint8_t heart[] = {0x06, 0x0f, 0x1f, 0x3e, 0x1f, 0x0f, 0x06};
+    TEST_ASSERT_EQUAL_MEMORY(heart, unpack(heart_filled).data(), sizeof(heart));
+}
+
+void test_decode_time()
+{
+    static const int ROUNDS = 5000;
+    uint8_t screen[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+    char line[120];
+
+    const PackedBitmap *assets[] = {&no_active_device, &splash_screen, &configuring};
+    const char *names[] = {"no_active_device", "splash_screen", "configuring"};
+    for (int a = 0; a < 3; a++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ROUNDS; i++)
+            blitPackedBitmap(screen, SCREEN_WIDTH, SCREEN_HEIGHT, 9, 8 + (i & 1) * 3, *assets[a]);
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+        snprintf(line, sizeof(line), "%s: %u -> %u B, %.2f us per draw (host)",
+                 names[a], (unsigned)(assets[a]->width * ((assets[a]->height + 7) / 8)), (unsigned)assets[a]->size,
+                 elapsed.count() / ROUNDS);
+        TEST_MESSAGE(line);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_of_runs_and_literals);
+    RUN_TEST(test_longest_runs_and_literals);
+    RUN_TEST(test_delta_chain_decodes_to_the_top_frame);
+    RUN_TEST(test_unaligned_and_clipped_draws);
+    RUN_TEST(test_aligned_draw_replaces_unaligned_draw_merges);
+    RUN_TEST(test_generated_assets_match_the_encoder);
+    RUN_TEST(test_decode_time);
+    return UNITY_END();
+}
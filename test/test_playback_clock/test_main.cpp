@@ -0,0 +1,146 @@
+#include <unity.h>
+#include "playbackClock.h"
+
+static PlaybackClock playback;
+
+void setUp()
+{
+    playback = PlaybackClock();
+}
+
+void tearDown() {}
+
+// One poll of a track playing since startMs from position 0. The server
+// reads its clock at the given fraction of the round trip. Returns how far
+// the shown position moved at the moment the response arrived.
+static float poll(unsigned long sentMs, unsigned long rttMs, float serverFraction, unsigned long startMs, bool stateChanged = false)
+{
+    unsigned long receivedMs = sentMs + rttMs;
+    float progressMs = (float)(long)(sentMs - startMs) + serverFraction * rttMs;
+
+    float before = playback.positionAt(receivedMs);
+    playback.observe(progressMs, sentMs, receivedMs, true, stateChanged);
+    return playback.positionAt(receivedMs) - before;
+}
+
+void test_first_poll_snaps_and_adds_half_the_round_trip()
+{
+    playback.observe(10000, 1000, 1200, true, false);
+
+    TEST_ASSERT_EQUAL(10100, (long)playback.positionAt(1200));
+    TEST_ASSERT_EQUAL(10600, (long)playback.positionAt(1700));
+
+    DriftStats drift = playback.takeDriftStats();
+    TEST_ASSERT_EQUAL(1, drift.snaps);
+    TEST_ASSERT_EQUAL(0, drift.polls);
+}
+
+void test_jittery_round_trips_give_bounded_corrections()
+{
+    // Round trips and server read points as seen on a busy WLAN
+    static const unsigned long rtts[] = {120, 80, 450, 95, 900, 60, 300, 150, 700, 110, 85, 620};
+    static const float fractions[] = {0.5f, 0.1f, 0.9f, 0.4f, 0.05f, 0.7f, 1.0f, 0.3f, 0.95f, 0.5f, 0.0f, 0.6f};
+    const int count = sizeof(rtts) / sizeof(rtts[0]);
+
+    poll(0, 100, 0.5f, 0);
+    playback.takeDriftStats();
+
+    float maxJump = 0;
+    for (int round = 0; round < 10; round++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            unsigned long sentMs = 1000 + (round * count + i) * 1000;
+            float jump = poll(sentMs, rtts[i], fractions[i], 0);
+
+            // A correction never moves further than the read point can be off
+            TEST_ASSERT_TRUE(fabsf(jump) <= rtts[i] / 2.0f);
+            maxJump = max(maxJump, fabsf(jump));
+
+            // The estimate stays close to the real position
+            unsigned long receivedMs = sentMs + rtts[i];
+            TEST_ASSERT_TRUE(fabsf(playback.positionAt(receivedMs) - receivedMs) < 250.0f);
+        }
+    }
+
+    DriftStats drift = playback.takeDriftStats();
+    TEST_ASSERT_EQUAL(10 * count, drift.polls);
+    TEST_ASSERT_EQUAL(0, drift.snaps);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, maxJump, drift.maxJumpMs);
+    // The filter shows less than the raw error it sees
+    TEST_ASSERT_TRUE(drift.totalJumpMs < drift.totalErrorMs);
+}
+
+void test_fast_steady_polls_settle()
+{
+    poll(0, 40, 0.5f, 0);
+    for (int i = 1; i <= 30; i++)
+        poll(i * 1000, 40, 0.5f, 0);
+
+    TEST_ASSERT_TRUE(fabsf(playback.positionAt(30040) - 30040) < 1.0f);
+    TEST_ASSERT_TRUE(playback.takeDriftStats().maxJumpMs < 1.0f);
+}
+
+void test_seek_snaps_to_the_new_position()
+{
+    poll(0, 100, 0.5f, 0);
+    poll(1000, 100, 0.5f, 0);
+
+    // Seeked 60 s ahead on another device
+    float jump = poll(2000, 100, 0.5f, (unsigned long)-60000);
+
+    TEST_ASSERT_EQUAL(62100, (long)playback.positionAt(2100));
+    TEST_ASSERT_EQUAL(60000, (long)jump);
+    DriftStats drift = playback.takeDriftStats();
+    TEST_ASSERT_EQUAL(2, drift.snaps);
+    TEST_ASSERT_EQUAL(1, drift.polls); // The seek is not counted as drift
+}
+
+void test_error_without_state_change_is_smoothed()
+{
+    poll(0, 100, 0.5f, 0);
+    poll(1000, 100, 0.5f, 0);
+
+    float jump = poll(2000, 100, 0.5f, (unsigned long)-400);
+
+    TEST_ASSERT_TRUE(jump > 0 && jump < 400);
+    TEST_ASSERT_EQUAL(1, playback.takeDriftStats().snaps);
+}
+
+void test_state_change_snaps_on_smaller_errors()
+{
+    poll(0, 100, 0.5f, 0);
+    poll(1000, 100, 0.5f, 0);
+
+    float snapped = poll(2000, 100, 0.5f, (unsigned long)-400, true);
+    TEST_ASSERT_EQUAL(400, (long)snapped);
+
+    // Below the state change limit it is still smoothed
+    float small = poll(3000, 100, 0.5f, (unsigned long)-500, true);
+    TEST_ASSERT_TRUE(small > 0 && small < 100);
+    TEST_ASSERT_EQUAL(2, playback.takeDriftStats().snaps);
+}
+
+void test_pause_snaps_and_freezes()
+{
+    poll(0, 100, 0.5f, 0);
+
+    playback.observe(5000, 5000, 5200, false, true);
+
+    TEST_ASSERT_EQUAL(5000, (long)playback.positionAt(5200)); // No round trip added
+    TEST_ASSERT_EQUAL(5000, (long)playback.positionAt(9000));
+    TEST_ASSERT_EQUAL(2, playback.takeDriftStats().snaps);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_poll_snaps_and_adds_half_the_round_trip);
+    RUN_TEST(test_jittery_round_trips_give_bounded_corrections);
+    RUN_TEST(test_fast_steady_polls_settle);
+    RUN_TEST(test_seek_snaps_to_the_new_position);
+    RUN_TEST(test_error_without_state_change_is_smoothed);
+    RUN_TEST(test_state_change_snaps_on_smaller_errors);
+    RUN_TEST(test_pause_snaps_and_freezes);
+    return UNITY_END();
+}
@@ -0,0 +1,122 @@
+#include <unity.h>
+#include "heapCounter.h"
+#include "jsonPool.h"
+#include "songDetails.h"
+#include "spotifyPayloads.h"
+
+// Same size as the player arena in spotifyClient.cpp
+static uint8_t playerArena[3072] __attribute__((aligned(8)));
+static JsonPool playerPool(playerArena, sizeof(playerArena), "player");
+
+void setUp() {}
+void tearDown() {}
+
+static void parsePlayer(const char *payload, SongDetails &song)
+{
+    JsonPoolLease lease(playerPool);
+    DeserializationError error = deserializeJson(lease.doc(), payload,
+                                                 DeserializationOption::Filter(playerFilter()));
+    TEST_ASSERT_FALSE(error);
+    readSongDetails(lease.doc()["item"], song);
+}
+
+void test_fixed_string_truncates_at_utf8_boundary()
+{
+    FixedString<6> text;
+
+    text = "abcd\xC3\xA9"; // "abcdé" needs 6 bytes, one more than fits
+    TEST_ASSERT_EQUAL_STRING("abcd", text.c_str());
+    TEST_ASSERT_EQUAL(4, text.length());
+
+    text = "abc\xC3\xA9"; // Exactly fits
+    TEST_ASSERT_EQUAL_STRING("abc\xC3\xA9", text.c_str());
+
+    text = nullptr;
+    TEST_ASSERT_TRUE(text.isEmpty());
+}
+
+void test_null_item_gives_placeholders()
+{
+    SongDetails song;
+    song.Id = "4PTG3Z6ehGkBFwjybzWkR8";
+
+    readSongDetails(JsonVariantConst(), song);
+
+    TEST_ASSERT_EQUAL_STRING("Unknown Artist", song.artist.c_str());
+    TEST_ASSERT_EQUAL_STRING("No Song Playing", song.song.c_str());
+    TEST_ASSERT_EQUAL(0, song.durationMs);
+    TEST_ASSERT_TRUE(song.Id.isEmpty());
+}
+
+void test_episode_gets_no_id()
+{
+    JsonDocument doc;
+    doc["name"] = "Episode 12";
+    doc["uri"] = "spotify:episode:512ojhOuo1ktJprKbVcKyQ";
+    doc["duration_ms"] = 3600000;
+    SongDetails song;
+    song.Id = "4PTG3Z6ehGkBFwjybzWkR8";
+
+    readSongDetails(doc.as<JsonVariantConst>(), song);
+
+    TEST_ASSERT_EQUAL_STRING("Unknown Artist", song.artist.c_str());
+    TEST_ASSERT_EQUAL_STRING("Episode 12", song.song.c_str());
+    TEST_ASSERT_TRUE(song.Id.isEmpty());
+}
+
+void test_player_payload_fills_song_details()
+{
+    SongDetails song;
+
+    parsePlayer(PLAYER_PAYLOAD, song);
+
+    TEST_ASSERT_EQUAL_STRING("Rick Astley", song.artist.c_str());
+    TEST_ASSERT_EQUAL_STRING("Never Gonna Give You Up", song.song.c_str());
+    TEST_ASSERT_EQUAL(213573, song.durationMs);
+    TEST_ASSERT_EQUAL_STRING("4PTG3Z6ehGkBFwjybzWkR8", song.Id.c_str());
+}
+
+void test_long_title_is_cut_on_a_character()
+{
+    SongDetails song;
+
+    parsePlayer(PLAYER_LONG_TITLES_PAYLOAD, song);
+
+    TEST_ASSERT_EQUAL_STRING("ROSAL\xC3\x8D" "A", song.artist.c_str());
+    // 127 bytes would end on the first byte of "é", so the cut goes before it
+    TEST_ASSERT_EQUAL(126, song.song.length());
+    TEST_ASSERT_EQUAL(0, strncmp(song.song.c_str(), "S\xC3\xADmbolo de una", 15));
+    TEST_ASSERT_EQUAL_STRING("aniversario, d", song.song.c_str() + 126 - 14);
+}
+
+void test_refresh_does_not_allocate()
+{
+    if (!HEAP_COUNTER_ACTIVE)
+        TEST_IGNORE_MESSAGE("No malloc hook on this libc");
+
+    SongDetails song;
+    // Warm up: builds the filter and the first high-water log line
+    parsePlayer(PLAYER_PAYLOAD, song);
+    parsePlayer(PLAYER_LONG_TITLES_PAYLOAD, song);
+
+    unsigned long before = heapCounter.allocations;
+    for (int i = 0; i < 100; i++)
+    {
+        parsePlayer((i & 1) ? PLAYER_PAYLOAD : PLAYER_LONG_TITLES_PAYLOAD, song);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, heapCounter.allocations - before);
+    TEST_ASSERT_EQUAL_STRING("Never Gonna Give You Up", song.song.c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_string_truncates_at_utf8_boundary);
+    RUN_TEST(test_null_item_gives_placeholders);
+    RUN_TEST(test_episode_gets_no_id);
+    RUN_TEST(test_player_payload_fills_song_details);
+    RUN_TEST(test_long_title_is_cut_on_a_character);
+    RUN_TEST(test_refresh_does_not_allocate);
+    return UNITY_END();
+}
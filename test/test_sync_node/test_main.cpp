@@ -0,0 +1,252 @@
+#include <unity.h>
+#include <deque>
+#include <vector>
+#include "syncNode.h"
+
+// A shared segment: what one link sends, every other link receives
+class StubLink : public SyncLink
+{
+public:
+    std::vector<StubLink *> *segment = nullptr;
+    std::deque<std::vector<uint8_t>> inbox;
+    bool sendDown = false; // Drops everything this node sends
+    bool receiveDown = false;
+
+    size_t receive(uint8_t *buffer, size_t size) override
+    {
+        if (inbox.empty())
+            return 0;
+        std::vector<uint8_t> packet = inbox.front();
+        inbox.pop_front();
+        size_t length = min(size, packet.size());
+        memcpy(buffer, packet.data(), length);
+        return length;
+    }
+
+    void send(const uint8_t *header, size_t headerLength, const uint8_t *body, size_t bodyLength) override
+    {
+        std::vector<uint8_t> packet(header, header + headerLength);
+        if (bodyLength > 0)
+            packet.insert(packet.end(), body, body + bodyLength);
+        for (StubLink *other : *segment)
+        {
+            if (other != this && !sendDown && !other->receiveDown)
+                other->inbox.push_back(packet);
+        }
+    }
+};
+
+struct RunCommand
+{
+    uint8_t type;
+    int32_t value;
+    unsigned long queuedAt;
+};
+
+// Records what the node asks of the player
+class StubPlayer : public SyncPlayer
+{
+public:
+    SyncState state;
+    unsigned long pollTime = 0;
+    int statesApplied = 0;
+    int trackInfoRequests = 0;
+    std::vector<RunCommand> commandsRun;
+    std::vector<RunCommand> journal;
+
+    size_t encodeState(uint8_t *buffer, size_t size) override
+    {
+        return encodeSyncState(buffer, size, state);
+    }
+
+    bool applyState(const uint8_t *buffer, size_t length) override
+    {
+        if (!decodeSyncState(buffer, length, state))
+            return false;
+        statesApplied++;
+        return true;
+    }
+
+    void runCommand(uint8_t type, int32_t value) override { commandsRun.push_back({type, value, millis()}); }
+    void journalCommand(uint8_t type, int32_t value, unsigned long queuedAt) override { journal.push_back({type, value, queuedAt}); }
+    void requestTrackInfo() override { trackInfoRequests++; }
+    unsigned long lastPollTime() override { return pollTime; }
+};
+
+static const uint32_t LOW_ID = 0x00A1B2C3;
+static const uint32_t HIGH_ID = 0x00F4E5D6;
+static const uint8_t CMD_NEXT = 2;
+
+struct Controller
+{
+    StubLink link;
+    StubPlayer player;
+    SyncNode node;
+    bool running = true; // Powered on
+
+    Controller() : node(link, player) {}
+};
+
+static std::vector<StubLink *> segment;
+static Controller *low;
+static Controller *high;
+
+static void run(unsigned long ms)
+{
+    for (unsigned long t = 0; t < ms; t += 10)
+    {
+        delay(10);
+        if (low->running)
+            low->node.service();
+        if (high->running)
+            high->node.service();
+    }
+}
+
+void setUp()
+{
+    nativeMicros = 1000000;
+    low = new Controller();
+    high = new Controller();
+    segment = {&low->link, &high->link};
+    low->link.segment = &segment;
+    high->link.segment = &segment;
+    low->player.state.song = "Never Gonna Give You Up";
+    low->player.state.flags = SYNC_FLAG_ACTIVE | SYNC_FLAG_PLAYING;
+
+    // The higher ID powers up first and leads until it hears the lower one
+    high->node.begin(HIGH_ID, 1000);
+    low->running = false;
+    run(500);
+    low->node.begin(LOW_ID, 5000);
+    low->running = true;
+}
+
+void tearDown()
+{
+    delete low;
+    delete high;
+}
+
+void test_lowest_id_leads()
+{
+    TEST_ASSERT_FALSE(high->node.following());
+    run(1500);
+
+    TEST_ASSERT_FALSE(low->node.following());
+    TEST_ASSERT_TRUE(high->node.following());
+    TEST_ASSERT_EQUAL_UINT32(LOW_ID, high->node.leader());
+    TEST_ASSERT_EQUAL(1, low->node.knownPeers());
+    TEST_ASSERT_EQUAL(1, high->node.knownPeers());
+}
+
+void test_follower_applies_the_leaders_state()
+{
+    run(1500);
+    int applied = high->player.statesApplied;
+    TEST_ASSERT_TRUE(applied > 0);
+    TEST_ASSERT_EQUAL_STRING("Never Gonna Give You Up", high->player.state.song.c_str());
+
+    // A fresh poll is published at once, not at the next heartbeat
+    low->player.state.song = "Together Forever";
+    low->player.pollTime = millis();
+    run(20);
+    TEST_ASSERT_EQUAL_STRING("Together Forever", high->player.state.song.c_str());
+    TEST_ASSERT_EQUAL(applied + 1, high->player.statesApplied);
+}
+
+void test_forwarded_command_runs_on_the_leader_and_is_acked()
+{
+    run(1500);
+    high->node.takeSyncStats();
+
+    TEST_ASSERT_TRUE(high->node.forwardCommand(CMD_NEXT, 0));
+    run(500);
+
+    TEST_ASSERT_EQUAL(1, low->player.commandsRun.size());
+    TEST_ASSERT_EQUAL(CMD_NEXT, low->player.commandsRun[0].type);
+    TEST_ASSERT_EQUAL(0, high->node.pendingCommands());
+    SyncStats stats = high->node.takeSyncStats();
+    TEST_ASSERT_EQUAL(0, stats.commandRetries);
+    TEST_ASSERT_EQUAL(0, stats.commandFallbacks);
+    TEST_ASSERT_TRUE(high->player.journal.empty());
+}
+
+void test_leader_does_not_forward()
+{
+    run(1500);
+    TEST_ASSERT_FALSE(low->node.forwardCommand(CMD_NEXT, 0));
+}
+
+void test_lost_ack_is_resent_and_run_once()
+{
+    run(1500);
+    low->link.sendDown = true; // The command arrives, the ack does not
+
+    high->node.forwardCommand(CMD_NEXT, 0);
+    run(SyncNode::ACK_TIMEOUT + 50);
+    TEST_ASSERT_EQUAL(1, low->player.commandsRun.size());
+    TEST_ASSERT_EQUAL(1, high->node.pendingCommands());
+
+    low->link.sendDown = false;
+    run(SyncNode::ACK_TIMEOUT + 50);
+
+    TEST_ASSERT_EQUAL(1, low->player.commandsRun.size());
+    TEST_ASSERT_EQUAL(0, high->node.pendingCommands());
+    TEST_ASSERT_TRUE(high->node.takeSyncStats().commandRetries >= 1);
+    TEST_ASSERT_TRUE(high->player.journal.empty());
+}
+
+void test_unacked_command_falls_back_to_the_journal()
+{
+    run(1500);
+    low->link.receiveDown = true; // Leader deaf, still sending state
+
+    unsigned long pressedAt = millis();
+    high->node.forwardCommand(CMD_NEXT, 0);
+    run(SyncNode::ACK_TIMEOUT * (SyncNode::MAX_ATTEMPTS + 1) + 100);
+
+    TEST_ASSERT_TRUE(low->player.commandsRun.empty());
+    TEST_ASSERT_EQUAL(1, high->player.journal.size());
+    TEST_ASSERT_EQUAL(CMD_NEXT, high->player.journal[0].type);
+    TEST_ASSERT_EQUAL(pressedAt, high->player.journal[0].queuedAt); // Expiry counts from the press
+    SyncStats stats = high->node.takeSyncStats();
+    TEST_ASSERT_EQUAL(SyncNode::MAX_ATTEMPTS - 1, stats.commandRetries);
+    TEST_ASSERT_EQUAL(1, stats.commandFallbacks);
+    TEST_ASSERT_TRUE(high->node.following()); // The leader is still heard
+}
+
+void test_follower_takes_over_when_the_leader_goes_quiet()
+{
+    run(1500);
+    int requests = high->player.trackInfoRequests;
+
+    low->running = false;
+    high->node.forwardCommand(CMD_NEXT, 0);
+    run(SyncNode::PEER_TIMEOUT + 200);
+
+    TEST_ASSERT_FALSE(high->node.following());
+    TEST_ASSERT_EQUAL(0, high->node.knownPeers());
+    TEST_ASSERT_EQUAL(requests + 1, high->player.trackInfoRequests); // Polls right away
+    TEST_ASSERT_EQUAL(1, high->player.journal.size());
+
+    // The old leader comes back and wins the election again
+    low->running = true;
+    low->link.inbox.clear();
+    run(1500);
+    TEST_ASSERT_TRUE(high->node.following());
+    TEST_ASSERT_EQUAL_UINT32(LOW_ID, high->node.leader());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lowest_id_leads);
+    RUN_TEST(test_follower_applies_the_leaders_state);
+    RUN_TEST(test_forwarded_command_runs_on_the_leader_and_is_acked);
+    RUN_TEST(test_leader_does_not_forward);
+    RUN_TEST(test_lost_ack_is_resent_and_run_once);
+    RUN_TEST(test_unacked_command_falls_back_to_the_journal);
+    RUN_TEST(test_follower_takes_over_when_the_leader_goes_quiet);
+    return UNITY_END();
+}
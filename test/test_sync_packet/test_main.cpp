@@ -0,0 +1,155 @@
+#include <unity.h>
+#include "syncPacket.h"
+
+void setUp() {}
+void tearDown() {}
+
+static SyncState sampleState()
+{
+    SyncState state;
+    state.flags = SYNC_FLAG_ACTIVE | SYNC_FLAG_PLAYING | SYNC_FLAG_LIKED;
+    state.volume = 42;
+    state.positionMs = 123456;
+    state.durationMs = 215000;
+    state.id = "4uLU6hMCjMI75M1A2tKUQC";
+    state.song = "Never Gonna Give You Up";
+    state.artist = "Rick Astley";
+    state.album = "Whenever You Need Somebody";
+    return state;
+}
+
+void test_state_round_trip()
+{
+    uint8_t buffer[512];
+    SyncState sent = sampleState();
+
+    size_t length = encodeSyncState(buffer, sizeof(buffer), sent);
+    TEST_ASSERT_TRUE(length > 0);
+
+    SyncState received;
+    TEST_ASSERT_TRUE(decodeSyncState(buffer, length, received));
+    TEST_ASSERT_EQUAL_UINT8(sent.flags, received.flags);
+    TEST_ASSERT_EQUAL_UINT8(42, received.volume);
+    TEST_ASSERT_EQUAL_UINT32(123456, received.positionMs);
+    TEST_ASSERT_EQUAL_UINT32(215000, received.durationMs);
+    TEST_ASSERT_EQUAL_STRING(sent.id.c_str(), received.id.c_str());
+    TEST_ASSERT_EQUAL_STRING(sent.song.c_str(), received.song.c_str());
+    TEST_ASSERT_EQUAL_STRING(sent.artist.c_str(), received.artist.c_str());
+    TEST_ASSERT_EQUAL_STRING(sent.album.c_str(), received.album.c_str());
+}
+
+void test_state_with_empty_strings_round_trips()
+{
+    uint8_t buffer[64];
+    SyncState sent = {};
+    sent.id = "";
+    sent.song = "";
+    sent.artist = "";
+    sent.album = "";
+
+    size_t length = encodeSyncState(buffer, sizeof(buffer), sent);
+    TEST_ASSERT_EQUAL(1 + 1 + 4 + 4 + 4, length); // Fixed fields plus four length bytes
+
+    SyncState received = sampleState();
+    TEST_ASSERT_TRUE(decodeSyncState(buffer, length, received));
+    TEST_ASSERT_EQUAL(0, received.song.length());
+    TEST_ASSERT_EQUAL(0, received.album.length());
+}
+
+void test_state_too_big_for_buffer_encodes_nothing()
+{
+    uint8_t buffer[32];
+    TEST_ASSERT_EQUAL(0, encodeSyncState(buffer, sizeof(buffer), sampleState()));
+}
+
+void test_truncated_state_is_rejected()
+{
+    uint8_t buffer[512];
+    size_t length = encodeSyncState(buffer, sizeof(buffer), sampleState());
+
+    SyncState received;
+    for (size_t cut = 0; cut < length; cut++)
+    {
+        TEST_ASSERT_FALSE(decodeSyncState(buffer, cut, received));
+    }
+}
+
+void test_command_round_trip_keeps_negative_and_large_values()
+{
+    uint8_t buffer[16];
+    int32_t values[] = {0, -5, 3600000, INT32_MIN, INT32_MAX};
+
+    for (int32_t value : values)
+    {
+        SyncCommand sent = {0x12345678, 0xFFFFFFFF, 4, value};
+        size_t length = encodeSyncCommand(buffer, sizeof(buffer), sent);
+        TEST_ASSERT_EQUAL(13, length);
+
+        SyncCommand received;
+        TEST_ASSERT_TRUE(decodeSyncCommand(buffer, length, received));
+        TEST_ASSERT_EQUAL_UINT32(sent.target, received.target);
+        TEST_ASSERT_EQUAL_UINT32(sent.commandId, received.commandId);
+        TEST_ASSERT_EQUAL_UINT8(4, received.type);
+        TEST_ASSERT_EQUAL_INT32(value, received.value);
+    }
+}
+
+void test_short_command_and_ack_are_rejected()
+{
+    uint8_t buffer[16];
+    SyncCommand command = {1, 2, 3, 4};
+    size_t length = encodeSyncCommand(buffer, sizeof(buffer), command);
+    TEST_ASSERT_FALSE(decodeSyncCommand(buffer, length - 1, command));
+
+    SyncAck ack = {1, 2};
+    length = encodeSyncAck(buffer, sizeof(buffer), ack);
+    TEST_ASSERT_EQUAL(8, length);
+    TEST_ASSERT_TRUE(decodeSyncAck(buffer, length, ack));
+    TEST_ASSERT_FALSE(decodeSyncAck(buffer, length - 1, ack));
+}
+
+void test_newer_sequences_are_accepted()
+{
+    TEST_ASSERT_TRUE(syncSequenceNewer(2, 1));
+    TEST_ASSERT_TRUE(syncSequenceNewer(1000, 1));
+    TEST_ASSERT_FALSE(syncSequenceNewer(5, 5));
+}
+
+void test_recent_reorders_are_dropped()
+{
+    TEST_ASSERT_FALSE(syncSequenceNewer(99, 100));
+    TEST_ASSERT_FALSE(syncSequenceNewer(100 - SYNC_REORDER_WINDOW + 1, 100));
+}
+
+void test_big_step_back_means_restart()
+{
+    TEST_ASSERT_TRUE(syncSequenceNewer(100 - SYNC_REORDER_WINDOW, 100));
+    TEST_ASSERT_TRUE(syncSequenceNewer(1, 5000));
+}
+
+void test_sequence_wrap()
+{
+    // Counting on past the wrap stays newer
+    TEST_ASSERT_TRUE(syncSequenceNewer(0, 0xFFFFFFFF));
+    TEST_ASSERT_TRUE(syncSequenceNewer(3, 0xFFFFFFFE));
+
+    // A late packet from before the wrap is still a reorder
+    TEST_ASSERT_FALSE(syncSequenceNewer(0xFFFFFFFE, 2));
+    TEST_ASSERT_FALSE(syncSequenceNewer(0xFFFFFFFF, 0));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_state_round_trip);
+    RUN_TEST(test_state_with_empty_strings_round_trips);
+    RUN_TEST(test_state_too_big_for_buffer_encodes_nothing);
+    RUN_TEST(test_truncated_state_is_rejected);
+    RUN_TEST(test_command_round_trip_keeps_negative_and_large_values);
+    RUN_TEST(test_short_command_and_ack_are_rejected);
+    RUN_TEST(test_newer_sequences_are_accepted);
+    RUN_TEST(test_recent_reorders_are_dropped);
+    RUN_TEST(test_big_step_back_means_restart);
+    RUN_TEST(test_sequence_wrap);
+    return UNITY_END();
+}
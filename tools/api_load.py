@@ -0,0 +1,64 @@
+"""Load test for the LAN control API.
+
+Opens N keep-alive HTTPS connections to the ESP and hammers GET /api/state
+for a fixed time, then prints requests per second and latency percentiles.
+Compare with the "LAN API" line the ESP prints over serial.
+
+    python tools/api_load.py 192.168.1.42 --clients 4 --seconds 20
+"""
+
+import argparse
+import http.client
+import ssl
+import threading
+import time
+
+
+def worker(host, deadline, latencies, errors):
+    context = ssl._create_unverified_context()  # The ESP uses a self-signed certificate
+    conn = None
+    while time.monotonic() < deadline:
+        try:
+            if conn is None:
+                conn = http.client.HTTPSConnection(host, 443, timeout=10, context=context)
+            start = time.monotonic()
+            conn.request("GET", "/api/state", headers={"Connection": "keep-alive"})
+            response = conn.getresponse()
+            response.read()
+            if response.status != 200:
+                errors.append(response.status)
+            latencies.append(time.monotonic() - start)
+        except (OSError, http.client.HTTPException) as e:
+            errors.append(str(e))
+            conn = None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("host")
+    parser.add_argument("--clients", type=int, default=4)
+    parser.add_argument("--seconds", type=float, default=20)
+    args = parser.parse_args()
+
+    latencies = []
+    errors = []
+    deadline = time.monotonic() + args.seconds
+    threads = [
+        threading.Thread(target=worker, args=(args.host, deadline, latencies, errors))
+        for _ in range(args.clients)
+    ]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    latencies.sort()
+    print("%d requests in %.0f s: %.1f req/s, %d errors" % (
+        len(latencies), args.seconds, len(latencies) / args.seconds, len(errors)))
+    if latencies:
+        for p in (50, 95, 99):
+            print("  p%d %.1f ms" % (p, latencies[min(len(latencies) - 1, len(latencies) * p // 100)] * 1000))
+
+
+if __name__ == "__main__":
+    main()
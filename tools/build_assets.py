@@ -0,0 +1,230 @@
+"""Bitmap asset pipeline.
+
+Converts the PNGs listed in assets/bitmaps/manifest.json into page-major,
+RLE-compressed bitmaps in src/bitmaps.h. Assets with a "base" are stored as
+an XOR delta against that asset, so shared frames are only stored once.
+
+Runs as a PlatformIO pre-build script, or standalone:
+    python tools/build_assets.py
+"""
+
+import json
+import os
+import struct
+import zlib
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO SCons environment)
+    ROOT = env["PROJECT_DIR"]  # noqa: F821
+except NameError:
+    env = None
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+ASSET_DIR = os.path.join(ROOT, "assets", "bitmaps")
+MANIFEST = os.path.join(ASSET_DIR, "manifest.json")
+OUTPUT = os.path.join(ROOT, "src", "bitmaps.h")
+
+
+# -------- PNG --------
+def read_png(path):
+    """Return (width, height, rows) with rows as lists of 0/1 (1 = lit)."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError("%s: not a PNG" % path)
+
+    pos = 8
+    idat = b""
+    palette = None
+    while pos < len(data):
+        length, ctype = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if ctype == b"IHDR":
+            width, height, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif ctype == b"PLTE":
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, len(chunk), 3)]
+        elif ctype == b"IDAT":
+            idat += chunk
+
+    if interlace:
+        raise ValueError("%s: interlaced PNGs are not supported" % path)
+
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+    bits_pp = depth * channels
+    stride = (width * bits_pp + 7) // 8
+    bpp = max(1, bits_pp // 8)
+    raw = zlib.decompress(idat)
+
+    rows = []
+    prev = bytearray(stride)
+    for y in range(height):
+        ftype = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + pred) & 0xFF
+        prev = line
+
+        row = []
+        for x in range(width):
+            if depth < 8:
+                bit = x * depth
+                sample = (line[bit // 8] >> (8 - depth - bit % 8)) & ((1 << depth) - 1)
+                level = sample * 255 // ((1 << depth) - 1)
+                if color == 3:
+                    level = sum(palette[sample]) // 3
+                row.append(1 if level >= 128 else 0)
+            else:
+                px = line[x * bpp:(x + 1) * bpp] if depth == 8 else line[x * bpp:(x + 1) * bpp:2]
+                if color == 3:
+                    level = sum(palette[px[0]]) // 3
+                elif color in (2, 6):
+                    level = (px[0] + px[1] + px[2]) // 3
+                else:
+                    level = px[0]
+                alpha = px[-1] if color in (4, 6) else 255
+                row.append(1 if level >= 128 and alpha >= 128 else 0)
+        rows.append(row)
+
+    return width, height, rows
+
+
+# -------- ENCODING --------
+def to_pages(width, height, rows):
+    """Page-major layout matching the SH1106 framebuffer: bit n = row n of the page."""
+    pages = (height + 7) // 8
+    out = bytearray(width * pages)
+    for y in range(height):
+        for x in range(width):
+            if rows[y][x]:
+                out[(y // 8) * width + x] |= 1 << (y % 8)
+    return out
+
+
+def rle(data):
+    """PackBits style: n < 128 -> n+1 literal bytes, n >= 128 -> next byte repeated n-126 times."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 129:
+            run += 1
+        if run >= 2:
+            out += bytes([run + 126, data[i]])
+            i += run
+            continue
+
+        start = i
+        while i < len(data) and i - start < 128:
+            if i + 1 < len(data) and data[i + 1] == data[i]:
+                break
+            i += 1
+        out += bytes([i - start - 1]) + data[start:i]
+    return out
+
+
+def unrle(data, size):
+    out = bytearray()
+    i = 0
+    while len(out) < size:
+        n = data[i]
+        if n < 128:
+            out += data[i + 1:i + 2 + n]
+            i += 2 + n
+        else:
+            out += bytes([data[i + 1]]) * (n - 126)
+            i += 2
+    return out
+
+
+def build(verbose=True):
+    with open(MANIFEST) as f:
+        manifest = json.load(f)
+
+    assets = {}
+    for entry in manifest:
+        width, height, rows = read_png(os.path.join(ASSET_DIR, entry["file"]))
+        assets[entry["name"]] = {
+            "entry": entry,
+            "width": width,
+            "height": height,
+            "pages": to_pages(width, height, rows),
+        }
+
+    lines = [
+        "// Generated by tools/build_assets.py from assets/bitmaps, do not edit",
+        "#ifndef BITMAPS_H",
+        "#define BITMAPS_H",
+        "",
+        '#include "packedBitmap.h"',
+        "",
+    ]
+    report = []
+    total_raw = 0
+    total_packed = 0
+
+    for entry in manifest:
+        name = entry["name"]
+        asset = assets[name]
+        pages = asset["pages"]
+        base = entry.get("base")
+
+        if base:
+            ref = assets[base]
+            if ref["width"] != asset["width"] or len(ref["pages"]) != len(pages):
+                raise ValueError("%s: base %s must have the same width and page count" % (name, base))
+            payload = bytes(a ^ b for a, b in zip(pages, ref["pages"]))
+        else:
+            payload = bytes(pages)
+
+        packed = rle(payload)
+        if unrle(packed, len(payload)) != payload:
+            raise ValueError("%s: RLE round trip failed" % name)
+
+        raw_size = (asset["width"] + 7) // 8 * asset["height"]
+        total_raw += raw_size
+        total_packed += len(packed)
+        report.append((name, raw_size, len(packed), base))
+
+        body = ", ".join("0x%02x" % b for b in packed)
+        lines.append("static const uint8_t PROGMEM %s_data[] = {%s};" % (name, body))
+        lines.append(
+            "static const PackedBitmap %s = {%d, %d, %d, %s_data, %s};"
+            % (name, asset["width"], asset["height"], len(packed), name, "&" + base if base else "nullptr")
+        )
+        lines.append("")
+
+    lines.append("#endif")
+    content = "\n".join(lines) + "\n"
+
+    old = None
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT) as f:
+            old = f.read()
+    if old != content:
+        with open(OUTPUT, "w") as f:
+            f.write(content)
+
+    if verbose:
+        print("Bitmap assets (flash bytes):")
+        for name, raw_size, packed_size, base in report:
+            note = " (delta vs %s)" % base if base else ""
+            print("  %-20s %5d -> %5d%s" % (name, raw_size, packed_size, note))
+        print("  %-20s %5d -> %5d" % ("total", total_raw, total_packed))
+
+
+if env is not None or __name__ == "__main__":
+    build()
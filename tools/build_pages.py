@@ -0,0 +1,98 @@
+"""Auth page pipeline.
+
+Fills CLIENT_ID and REDIRECT_URI from src/secrets.h into the HTML templates
+in assets/pages, gzips them and writes src/pages.h, so the ESP serves the
+pages straight from flash with Content-Encoding: gzip.
+
+Runs as a PlatformIO pre-build script, or standalone:
+    python tools/build_pages.py
+"""
+
+import gzip
+import html
+import os
+import re
+
+try:
+    Import("env")  # noqa: F821 (PlatformIO SCons environment)
+    ROOT = env["PROJECT_DIR"]  # noqa: F821
+except NameError:
+    env = None
+    ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+PAGE_DIR = os.path.join(ROOT, "assets", "pages")
+SECRETS = os.path.join(ROOT, "src", "secrets.h")
+SECRETS_EXAMPLE = os.path.join(ROOT, "src", "secrets_EXAMPLE.h")
+OUTPUT = os.path.join(ROOT, "src", "pages.h")
+
+# Template file -> C identifier
+PAGES = [
+    ("main.html", "mainPage"),
+    ("error.html", "errorPage"),
+]
+
+
+def read_secrets():
+    path = SECRETS
+    if not os.path.exists(path):
+        print("build_pages: src/secrets.h not found, using placeholders from secrets_EXAMPLE.h")
+        path = SECRETS_EXAMPLE
+    with open(path) as f:
+        text = f.read()
+
+    values = {}
+    for name in ("CLIENT_ID", "REDIRECT_URI"):
+        match = re.search(r'#define\s+%s\s+"([^"]*)"' % name, text)
+        if not match:
+            raise ValueError("%s: %s is not defined" % (path, name))
+        values[name] = match.group(1)
+    return values
+
+
+def build(verbose=True):
+    values = read_secrets()
+
+    lines = [
+        "// Generated by tools/build_pages.py from assets/pages, do not edit",
+        "#ifndef PAGES_H",
+        "#define PAGES_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+    ]
+    report = []
+
+    for filename, name in PAGES:
+        with open(os.path.join(PAGE_DIR, filename)) as f:
+            page = f.read()
+        for key, value in values.items():
+            page = page.replace("{{%s}}" % key, html.escape(value, quote=True))
+
+        raw = page.encode("utf-8")
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)  # mtime=0 keeps the output stable
+        report.append((name, len(raw), len(packed)))
+
+        body = ", ".join("0x%02x" % b for b in packed)
+        lines.append("static const uint8_t %s[] PROGMEM = {%s};" % (name, body))
+        lines.append("static const size_t %sLength = %d;" % (name, len(packed)))
+        lines.append("")
+
+    lines.append("#endif")
+    content = "\n".join(lines) + "\n"
+
+    old = None
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT) as f:
+            old = f.read()
+    if old != content:
+        with open(OUTPUT, "w") as f:
+            f.write(content)
+
+    if verbose:
+        print("Auth pages (flash bytes):")
+        for name, raw_size, packed_size in report:
+            print("  %-20s %5d -> %5d" % (name, raw_size, packed_size))
+
+
+if env is not None or __name__ == "__main__":
+    build()